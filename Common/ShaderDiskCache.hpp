@@ -0,0 +1,34 @@
+#ifndef RADIUMENGINE_SHADERDISKCACHE_HPP
+#define RADIUMENGINE_SHADERDISKCACHE_HPP
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+namespace Ra {
+
+/// Move the on-disk shader cache of the OpenGL driver to the application cache location, in a
+/// "shaders" subdirectory, and make sure the NVIDIA cache is not disabled.
+///
+/// This does not add a cache : Mesa and recent NVIDIA drivers already keep compiled shaders on
+/// disk by default, in a per user location. It only gives the applications their own, known
+/// cache directory. Explicit user settings are kept.
+/// Must be called before the OpenGL context is created.
+inline void relocateShaderDiskCache() {
+    const QString dir =
+        QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/shaders";
+    if ( !QDir().mkpath( dir ) ) { return; }
+    const QByteArray path = QFile::encodeName( dir );
+    // Mesa
+    if ( qEnvironmentVariableIsEmpty( "MESA_SHADER_CACHE_DIR" ) )
+    { qputenv( "MESA_SHADER_CACHE_DIR", path ); }
+    // NVIDIA
+    if ( qEnvironmentVariableIsEmpty( "__GL_SHADER_DISK_CACHE" ) )
+    { qputenv( "__GL_SHADER_DISK_CACHE", "1" ); }
+    if ( qEnvironmentVariableIsEmpty( "__GL_SHADER_DISK_CACHE_PATH" ) )
+    { qputenv( "__GL_SHADER_DISK_CACHE_PATH", path ); }
+}
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_SHADERDISKCACHE_HPP
@@ -0,0 +1,136 @@
+#ifndef RADIUMENGINE_SHADERINCLUDERESOLVER_HPP
+#define RADIUMENGINE_SHADERINCLUDERESOLVER_HPP
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QString>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Ra {
+
+/// Replace the #include "file" directives of shader sources by the content of the files, as the
+/// engine ShaderProgram does with the named strings of the ShaderProgramManager.
+///
+/// Included files are searched in the directory of the including file, then by file name in the
+/// search directories and their subdirectories. The resolved text of each file is memoized with
+/// the files it includes : it is only read and resolved again when one of them is modified.
+/// Includes that are not found are left in the text.
+class ShaderIncludeResolver
+{
+  public:
+    /// Add a directory whose files, and the files of its subdirectories, can be included by
+    /// their name.
+    void addSearchDirectory( const QString& dir ) {
+        QDirIterator it( dir, QDir::Files, QDirIterator::Subdirectories );
+        while ( it.hasNext() )
+        {
+            const QFileInfo info( it.next() );
+            m_filesByName.emplace( info.fileName(), info.canonicalFilePath() );
+        }
+    }
+
+    /// Source with its includes resolved. Relative includes are searched in directory first.
+    std::string resolve( const std::string& source, const QString& directory = QString() ) {
+        std::vector<QString> includes;
+        return resolveText( source, directory, 0, includes );
+    }
+
+  private:
+    /// Resolved text of a file, and the files it directly includes.
+    struct File {
+        QDateTime modified;
+        std::string text;
+        std::vector<QString> includes;
+    };
+
+    /// Deeper includes are considered as a cycle and left unresolved.
+    static constexpr int s_maxDepth {32};
+
+    std::string resolveText( const std::string& source,
+                             const QString& directory,
+                             int depth,
+                             std::vector<QString>& includes ) {
+        static const QRegularExpression includeDecl(
+            R"(^[ \t]*#[ \t]*include[ \t]*["<]([^">]+)[">][^\n]*$)",
+            QRegularExpression::MultilineOption );
+
+        const QString text = QString::fromStdString( source );
+        auto it            = includeDecl.globalMatch( text );
+        if ( !it.hasNext() ) { return source; }
+
+        std::string resolved;
+        int last = 0;
+        while ( it.hasNext() )
+        {
+            const auto match   = it.next();
+            const QString path = findFile( match.captured( 1 ), directory );
+            resolved += text.mid( last, match.capturedStart() - last ).toStdString();
+            const File* file = path.isEmpty() ? nullptr : getFile( path, depth + 1 );
+            if ( file == nullptr ) { resolved += match.captured( 0 ).toStdString(); }
+            else
+            {
+                resolved += file->text;
+                includes.push_back( path );
+            }
+            last = match.capturedEnd();
+        }
+        resolved += text.mid( last ).toStdString();
+        return resolved;
+    }
+
+    /// Memoized resolved file, nullptr if it cannot be read or includes itself.
+    const File* getFile( const QString& path, int depth ) {
+        if ( depth > s_maxDepth ) { return nullptr; }
+        auto it = m_files.find( path );
+        if ( it != m_files.end() && isUpToDate( it->second, path, 0 ) ) { return &it->second; }
+
+        QFile f( path );
+        if ( !f.open( QIODevice::ReadOnly | QIODevice::Text ) ) { return nullptr; }
+        File file;
+        file.modified = QFileInfo( path ).lastModified();
+        file.text     = resolveText( f.readAll().toStdString(),
+                                     QFileInfo( path ).absolutePath(),
+                                     depth,
+                                     file.includes );
+        file.text += "\n";
+        return &( m_files[path] = std::move( file ) );
+    }
+
+    /// The file and the files it includes were not modified since they were resolved.
+    bool isUpToDate( const File& file, const QString& path, int depth ) const {
+        if ( depth > s_maxDepth || QFileInfo( path ).lastModified() != file.modified )
+        { return false; }
+        for ( const auto& include : file.includes )
+        {
+            auto it = m_files.find( include );
+            if ( it == m_files.end() || !isUpToDate( it->second, include, depth + 1 ) )
+            { return false; }
+        }
+        return true;
+    }
+
+    QString findFile( const QString& name, const QString& directory ) const {
+        if ( !directory.isEmpty() )
+        {
+            const QFileInfo local( QDir( directory ).filePath( name ) );
+            if ( local.isFile() ) { return local.canonicalFilePath(); }
+        }
+        // Named strings are registered with a leading '/'.
+        auto it = m_filesByName.find( QFileInfo( name ).fileName() );
+        return it != m_filesByName.end() ? it->second : QString();
+    }
+
+    std::map<QString, QString> m_filesByName;
+    std::map<QString, File> m_files;
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_SHADERINCLUDERESOLVER_HPP
@@ -0,0 +1,187 @@
+#include <BenchmarkRunner.hpp>
+#include <MainApplication.hpp>
+
+#include <Core/Utils/Log.hpp>
+#include <Engine/Scene/Camera.hpp>
+#include <Gui/MainWindowInterface.hpp>
+#include <Gui/Viewer/CameraManipulator.hpp>
+#include <Gui/Viewer/Viewer.hpp>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace Ra {
+
+using namespace Core::Utils; // log
+
+namespace {
+Core::Vector3 toVector3( const QJsonValue& value, const Core::Vector3& defaultValue ) {
+    const QJsonArray a = value.toArray();
+    if ( a.size() != 3 ) { return defaultValue; }
+    return {Scalar( a[0].toDouble() ), Scalar( a[1].toDouble() ), Scalar( a[2].toDouble() )};
+}
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner( MainApplication* app, const BenchmarkOptions& options ) :
+    QObject( app ),
+    m_app( app ),
+    m_options( options ) {}
+
+BenchmarkOptions BenchmarkRunner::parseArguments( int& argc, char** argv ) {
+    BenchmarkOptions options;
+    int kept = 1;
+    for ( int i = 1; i < argc; ++i )
+    {
+        const bool hasValue = i + 1 < argc;
+        if ( std::strcmp( argv[i], "--bench" ) == 0 && hasValue )
+        {
+            options.enabled   = true;
+            options.sceneFile = argv[++i];
+        }
+        else if ( std::strcmp( argv[i], "--camera-path" ) == 0 && hasValue )
+        { options.cameraPathFile = argv[++i]; }
+        else if ( std::strcmp( argv[i], "--frames" ) == 0 && hasValue )
+        { options.numFrames = uint( std::max( 1, std::atoi( argv[++i] ) ) ); }
+        else if ( std::strcmp( argv[i], "--bench-output" ) == 0 && hasValue )
+        { options.outputFile = argv[++i]; }
+        else if ( std::strcmp( argv[i], "--software-gl" ) == 0 )
+        { options.softwareGL = true; }
+        else
+        { argv[kept++] = argv[i]; }
+    }
+    argc       = kept;
+    argv[argc] = nullptr;
+    return options;
+}
+
+void BenchmarkRunner::setupHeadlessEnvironment( const BenchmarkOptions& options ) {
+    // Do not override an explicit user choice (e.g. running under xvfb-run with xcb).
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+    { qputenv( "QT_QPA_PLATFORM", "offscreen" ); }
+    if ( options.softwareGL )
+    {
+        qputenv( "LIBGL_ALWAYS_SOFTWARE", "1" );
+        qputenv( "GALLIUM_DRIVER", "llvmpipe" );
+    }
+}
+
+bool BenchmarkRunner::start() {
+    if ( !m_options.cameraPathFile.empty() && !loadCameraPath() ) { return false; }
+
+    if ( !m_app->loadFile( QString::fromStdString( m_options.sceneFile ) ) )
+    {
+        LOG( logERROR ) << "Benchmark : unable to load " << m_options.sceneFile;
+        return false;
+    }
+
+    m_output.open( m_options.outputFile );
+    if ( !m_output )
+    {
+        LOG( logERROR ) << "Benchmark : unable to open " << m_options.outputFile;
+        return false;
+    }
+    m_output << "frame,frame_us,tasks_us,render_us,update_us,feed_queues_us,main_render_us,"
+                "post_process_us\n";
+
+    LOG( logINFO ) << "Benchmark : " << m_options.sceneFile << ", " << m_options.numFrames
+                   << " frames, " << m_cameraPath.size() << " camera keyframes";
+
+    // Ask for the stats of every single frame.
+    m_app->framesCountForStatsChanged( 1 );
+    connect( m_app,
+             &Gui::BaseApplication::updateFrameStats,
+             this,
+             &BenchmarkRunner::onFrameStats );
+
+    applyCamera( 0 );
+    m_app->setContinuousUpdate( true );
+    return true;
+}
+
+bool BenchmarkRunner::loadCameraPath() {
+    QFile file( QString::fromStdString( m_options.cameraPathFile ) );
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+        LOG( logERROR ) << "Benchmark : unable to open camera path " << m_options.cameraPathFile;
+        return false;
+    }
+
+    const QJsonArray keyframes =
+        QJsonDocument::fromJson( file.readAll() ).object().value( "keyframes" ).toArray();
+    for ( const auto& k : keyframes )
+    {
+        const QJsonObject key = k.toObject();
+        m_cameraPath.push_back( {toVector3( key.value( "position" ), Core::Vector3::Zero() ),
+                                 toVector3( key.value( "target" ), -Core::Vector3::UnitZ() ),
+                                 toVector3( key.value( "up" ), Core::Vector3::UnitY() )} );
+    }
+
+    if ( m_cameraPath.empty() )
+    {
+        LOG( logERROR ) << "Benchmark : no keyframe in " << m_options.cameraPathFile;
+        return false;
+    }
+    return true;
+}
+
+void BenchmarkRunner::applyCamera( uint frame ) {
+    if ( m_cameraPath.empty() ) { return; }
+
+    CameraKey key = m_cameraPath.front();
+    if ( m_cameraPath.size() > 1 && m_options.numFrames > 1 )
+    {
+        const Scalar t = Scalar( frame ) / Scalar( m_options.numFrames - 1 ) *
+                         Scalar( m_cameraPath.size() - 1 );
+        const auto i   = std::min( size_t( t ), m_cameraPath.size() - 2 );
+        const Scalar a = t - Scalar( i );
+        const auto& k0 = m_cameraPath[i];
+        const auto& k1 = m_cameraPath[i + 1];
+        key.position   = ( 1_ra - a ) * k0.position + a * k1.position;
+        key.target     = ( 1_ra - a ) * k0.target + a * k1.target;
+        key.up         = ( ( 1_ra - a ) * k0.up + a * k1.up ).normalized();
+    }
+
+    auto camera = m_app->m_mainWindow->getViewer()->getCameraManipulator()->getCamera();
+    camera->setPosition( key.position );
+    camera->setDirection( ( key.target - key.position ).normalized() );
+    camera->setUpVector( key.up );
+}
+
+void BenchmarkRunner::onFrameStats( const std::vector<Gui::FrameTimerData>& stats ) {
+    for ( const auto& s : stats )
+    {
+        if ( m_measuredFrames >= m_options.numFrames ) { break; }
+
+        const auto& r        = s.renderData;
+        const long frameTime = getIntervalMicro( s.frameStart, s.frameEnd );
+        m_output << s.numFrame << ',' << frameTime << ','
+                 << getIntervalMicro( s.tasksStart, s.tasksEnd ) << ','
+                 << getIntervalMicro( r.renderStart, r.renderEnd ) << ','
+                 << getIntervalMicro( r.renderStart, r.updateEnd ) << ','
+                 << getIntervalMicro( r.updateEnd, r.feedRenderQueuesEnd ) << ','
+                 << getIntervalMicro( r.feedRenderQueuesEnd, r.mainRenderEnd ) << ','
+                 << getIntervalMicro( r.mainRenderEnd, r.postProcessEnd ) << '\n';
+        m_sumFrame += frameTime;
+        ++m_measuredFrames;
+    }
+
+    if ( m_measuredFrames < m_options.numFrames )
+    {
+        applyCamera( m_measuredFrames );
+        return;
+    }
+
+    m_output.close();
+    LOG( logINFO ) << "Benchmark : average frame time " << m_sumFrame / m_measuredFrames
+                   << " us, timings written to " << m_options.outputFile;
+    disconnect( m_app, nullptr, this, nullptr );
+    m_app->appNeedsToQuit();
+}
+
+} // namespace Ra
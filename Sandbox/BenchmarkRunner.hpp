@@ -0,0 +1,87 @@
+#ifndef RADIUMENGINE_BENCHMARKRUNNER_HPP
+#define RADIUMENGINE_BENCHMARKRUNNER_HPP
+
+#include <Core/Types.hpp>
+#include <Gui/TimerData/FrameTimerData.hpp>
+
+#include <QObject>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Ra {
+class MainApplication;
+
+/// Command line options of the benchmark mode.
+struct BenchmarkOptions {
+    /// True when --bench was given on the command line.
+    bool enabled{false};
+    /// Force Mesa's software rasterizer (llvmpipe).
+    bool softwareGL{false};
+    /// Scene file loaded through the application loaders.
+    std::string sceneFile;
+    /// Optional json file describing the camera keyframes.
+    std::string cameraPathFile;
+    /// Csv file receiving the per-frame timings.
+    std::string outputFile{"benchmark.csv"};
+    /// Number of measured frames.
+    uint numFrames{100};
+};
+
+/// Headless benchmark of the Sandbox: loads a scene, replays a camera path for a fixed number of
+/// frames, writes the per-frame FrameTimerData to a csv file and quits the application.
+///
+/// The camera path is a json file of the form
+/// \code
+/// { "keyframes" : [ { "position" : [x, y, z], "target" : [x, y, z], "up" : [x, y, z] }, ... ] }
+/// \endcode
+/// where "up" is optional. Keyframes are evenly distributed over the measured frames and
+/// linearly interpolated.
+class BenchmarkRunner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    BenchmarkRunner( MainApplication* app, const BenchmarkOptions& options );
+
+    /// Extract the benchmark options from the command line.
+    /// Recognized options are removed from argv so that the remaining ones can be parsed by
+    /// Ra::Gui::BaseApplication.
+    static BenchmarkOptions parseArguments( int& argc, char** argv );
+
+    /// Configure Qt and the OpenGL driver to render without a display, must be called before the
+    /// application is created.
+    static void setupHeadlessEnvironment( const BenchmarkOptions& options );
+
+    /// Load the scene and the camera path and start measuring.
+    /// \return false if the benchmark could not be started.
+    bool start();
+
+  private slots:
+    /// Receives the timings of each frame (stats are requested for every frame).
+    void onFrameStats( const std::vector<Ra::Gui::FrameTimerData>& stats );
+
+  private:
+    struct CameraKey {
+        Core::Vector3 position;
+        Core::Vector3 target;
+        Core::Vector3 up;
+    };
+
+    bool loadCameraPath();
+
+    /// Place the camera on the path according to the measured frame index.
+    void applyCamera( uint frame );
+
+    MainApplication* m_app;
+    BenchmarkOptions m_options;
+    std::vector<CameraKey> m_cameraPath;
+    std::ofstream m_output;
+    uint m_measuredFrames{0};
+    long m_sumFrame{0};
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_BENCHMARKRUNNER_HPP
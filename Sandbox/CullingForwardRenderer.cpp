@@ -0,0 +1,135 @@
+#include <CullingForwardRenderer.hpp>
+#include <SceneAabbCache.hpp>
+
+#include <Engine/Data/Mesh.hpp>
+#include <Engine/Data/ViewingParameters.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+
+#include <QRunnable>
+#include <QSemaphore>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace Ra {
+
+namespace {
+/// Run a function, then release a semaphore the rendering thread waits on.
+class CullTask : public QRunnable
+{
+  public:
+    CullTask( std::function<void()> cull, QSemaphore& done ) :
+        m_cull( std::move( cull ) ),
+        m_done( done ) {}
+
+    void run() override {
+        m_cull();
+        m_done.release();
+    }
+
+  private:
+    std::function<void()> m_cull;
+    QSemaphore& m_done;
+};
+} // namespace
+
+CullingForwardRenderer::CullingForwardRenderer( SceneAabbCache& aabbCache ) :
+    ForwardRenderer(), m_aabbCache( aabbCache ) {
+    // Threads are started once and kept waiting between frames.
+    m_cullingThreads.setExpiryTimeout( -1 );
+}
+
+void CullingForwardRenderer::updateStepInternal(
+    const Engine::Data::ViewingParameters& renderData ) {
+    m_culledCount    = 0;
+    m_culledFaces    = 0;
+    m_culledVertices = 0;
+    // The render queues are filled again for each frame, culled objects are back in the
+    // queue at the next one.
+    if ( m_cullingEnabled ) { cullRenderObjects( renderData ); }
+    ForwardRenderer::updateStepInternal( renderData );
+}
+
+void CullingForwardRenderer::cullRenderObjects( const Engine::Data::ViewingParameters& renderData ) {
+    // Frustum planes extracted from the view-projection matrix (Gribb & Hartmann) : a world point
+    // p is inside the frustum when all the components of planes * ( p, 1 ) are positive.
+    const Core::Matrix4 viewProj = renderData.projMatrix * renderData.viewMatrix;
+    Eigen::Matrix<Scalar, 6, 4> planes;
+    planes.row( 0 ) = viewProj.row( 3 ) + viewProj.row( 0 );
+    planes.row( 1 ) = viewProj.row( 3 ) - viewProj.row( 0 );
+    planes.row( 2 ) = viewProj.row( 3 ) + viewProj.row( 1 );
+    planes.row( 3 ) = viewProj.row( 3 ) - viewProj.row( 1 );
+    planes.row( 4 ) = viewProj.row( 3 ) + viewProj.row( 2 );
+    planes.row( 5 ) = viewProj.row( 3 ) - viewProj.row( 2 );
+    const Eigen::Matrix<Scalar, 6, 3> absNormals = planes.leftCols<3>().cwiseAbs();
+
+    auto& renderObjects = m_fancyRenderObjects;
+    std::vector<char> culled( renderObjects.size(), 0 );
+
+    // Each task owns a disjoint range of render objects, so the cached boxes can be refreshed
+    // concurrently.
+    auto cullRange = [&]( size_t begin, size_t end ) {
+        for ( size_t i = begin; i < end; ++i )
+        {
+            const auto& ro = renderObjects[i];
+            if ( !ro->isVisible() ) { continue; }
+            const Core::Aabb aabb = m_aabbCache.getWorldAabb( ro->getIndex() );
+            if ( aabb.isEmpty() ) { continue; }
+
+            // The six planes are tested at once : the signed distances of the box center, moved
+            // towards each plane by the box extent projected on its normal, are all positive
+            // unless the whole box is outside of a plane.
+            const Core::Vector3 center = aabb.center();
+            const Core::Vector4 point( center.x(), center.y(), center.z(), 1_ra );
+            const Eigen::Matrix<Scalar, 6, 1> distances =
+                planes * point + absNormals * ( aabb.sizes() / 2_ra );
+            culled[i] = ( distances.array() < 0_ra ).any();
+        }
+    };
+
+    // The rendering thread takes the first range.
+    const size_t numThreads = size_t( std::max( 0, m_cullingThreads.maxThreadCount() ) ) + 1;
+    const size_t numTasks =
+        std::min( numThreads, ( renderObjects.size() + s_minTaskSize - 1 ) / s_minTaskSize );
+    if ( numTasks <= 1 ) { cullRange( 0, renderObjects.size() ); }
+    else
+    {
+        const size_t taskSize = ( renderObjects.size() + numTasks - 1 ) / numTasks;
+        QSemaphore done;
+        int started = 0;
+        for ( size_t begin = taskSize; begin < renderObjects.size(); begin += taskSize )
+        {
+            const size_t end = std::min( begin + taskSize, renderObjects.size() );
+            m_cullingThreads.start(
+                new CullTask( [&cullRange, begin, end]() { cullRange( begin, end ); }, done ) );
+            ++started;
+        }
+        cullRange( 0, taskSize );
+        done.acquire( started );
+    }
+
+    // Compact the queue, keeping the submission order of the remaining objects.
+    size_t kept = 0;
+    for ( size_t i = 0; i < renderObjects.size(); ++i )
+    {
+        if ( culled[i] )
+        {
+            const auto& mesh = renderObjects[i]->getMesh();
+            ++m_culledCount;
+            if ( mesh != nullptr )
+            {
+                m_culledFaces += mesh->getNumFaces();
+                m_culledVertices += mesh->getNumVertices();
+            }
+        }
+        else
+        {
+            if ( kept != i ) { renderObjects[kept] = std::move( renderObjects[i] ); }
+            ++kept;
+        }
+    }
+    renderObjects.resize( kept );
+}
+
+} // namespace Ra
@@ -0,0 +1,62 @@
+#ifndef RADIUMENGINE_CULLINGFORWARDRENDERER_HPP
+#define RADIUMENGINE_CULLINGFORWARDRENDERER_HPP
+
+#include <Engine/Rendering/ForwardRenderer.hpp>
+
+#include <QThreadPool>
+
+namespace Ra {
+class SceneAabbCache;
+} // namespace Ra
+
+namespace Ra {
+
+/// Forward renderer that does not submit the render objects outside of the view frustum.
+///
+/// Before each frame, the world boxes of the geometry render objects, provided by a
+/// SceneAabbCache, are tested in parallel against the 6 planes of the view frustum, by the
+/// calling thread and the threads of a pool kept for the lifetime of the renderer. Objects
+/// entirely on the outer side of one plane are removed from the render queue of the frame.
+/// Objects that are not tracked by the cache are always drawn.
+class CullingForwardRenderer : public Engine::Rendering::ForwardRenderer
+{
+  public:
+    explicit CullingForwardRenderer( SceneAabbCache& aabbCache );
+
+    std::string getRendererName() const override { return "Culling Forward Renderer"; }
+
+    /// Enable or disable the culling stage, enabled by default.
+    void setCullingEnabled( bool enabled ) { m_cullingEnabled = enabled; }
+
+    /// Number of visible render objects culled during the last frame.
+    size_t getCulledCount() const { return m_culledCount; }
+
+    /// Number of faces of the render objects culled during the last frame.
+    size_t getCulledFaces() const { return m_culledFaces; }
+
+    /// Number of vertices of the render objects culled during the last frame.
+    size_t getCulledVertices() const { return m_culledVertices; }
+
+  protected:
+    void updateStepInternal( const Engine::Data::ViewingParameters& renderData ) override;
+
+  private:
+    /// Remove the render objects outside of the view frustum from the render queue.
+    void cullRenderObjects( const Engine::Data::ViewingParameters& renderData );
+
+    /// Minimum number of render objects processed by each parallel task.
+    static constexpr size_t s_minTaskSize{256};
+
+    SceneAabbCache& m_aabbCache;
+    bool m_cullingEnabled{true};
+    /// Threads testing the render objects along with the rendering thread.
+    QThreadPool m_cullingThreads;
+
+    size_t m_culledCount{0};
+    size_t m_culledFaces{0};
+    size_t m_culledVertices{0};
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_CULLINGFORWARDRENDERER_HPP
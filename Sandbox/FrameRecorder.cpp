@@ -0,0 +1,182 @@
+#include <FrameRecorder.hpp>
+
+#include <Core/Utils/Log.hpp>
+#include <Engine/Data/Texture.hpp>
+#include <Engine/Rendering/Renderer.hpp>
+#include <Gui/Viewer/Viewer.hpp>
+
+#include <QDir>
+#include <QImage>
+#include <QRunnable>
+
+#include <cstring>
+
+#include <glbinding/gl/gl.h>
+
+namespace Ra {
+
+using namespace Core::Utils; // log
+using namespace gl;
+
+namespace {
+/// Flip and save an image read back from OpenGL, then free an encoding slot.
+class ImageEncoder : public QRunnable
+{
+  public:
+    ImageEncoder( QImage image, QString filename, QSemaphore& slots ) :
+        m_image( std::move( image ) ),
+        m_filename( std::move( filename ) ),
+        m_slots( slots ) {}
+
+    void run() override {
+        // OpenGL rows start at the bottom of the image, as in Renderer::grabFrame the rows are
+        // flipped to write the image top to bottom.
+        if ( !m_image.mirrored().save( m_filename ) )
+        { LOG( logERROR ) << "Unable to write " << m_filename.toStdString(); }
+        m_slots.release();
+    }
+
+  private:
+    QImage m_image;
+    QString m_filename;
+    QSemaphore& m_slots;
+};
+} // namespace
+
+FrameRecorder::FrameRecorder( Gui::Viewer* viewer, QObject* parent ) :
+    QObject( parent ),
+    m_viewer( viewer ),
+    m_outputFolder( "." ),
+    m_encoderSlots( s_maxPendingImages ) {
+    m_pollTimer.setInterval( 16 );
+    connect( &m_pollTimer, &QTimer::timeout, this, [this]() { processReadbacks(); } );
+}
+
+FrameRecorder::~FrameRecorder() {
+    // The viewer may already be destroyed, buffers are released with its context.
+    m_encoders.waitForDone();
+}
+
+void FrameRecorder::setRecording( bool recording ) {
+    m_recording = recording;
+    if ( !recording ) { releaseBuffers(); }
+}
+
+void FrameRecorder::snapshot() {
+    // A single frame : waiting for its transfer is cheaper than keeping the buffers around.
+    readback();
+    processReadbacks( true );
+    if ( !m_recording ) { releaseBuffers(); }
+}
+
+void FrameRecorder::onFrameComplete() {
+    if ( !m_recording ) { return; }
+    processReadbacks();
+    readback();
+}
+
+void FrameRecorder::readback() {
+    // Nothing is rendered before the OpenGL initialization of the viewer.
+    auto renderer = m_viewer->getRenderer();
+    if ( renderer == nullptr ) { return; }
+    auto texture = renderer->getDisplayTexture();
+    if ( texture == nullptr ) { return; }
+
+    Readback& r = m_readbacks[m_next];
+    // The ring is full, the oldest transfer has to be complete before reusing its buffer.
+    if ( r.fence != nullptr ) { processReadbacks( true ); }
+    if ( r.fence != nullptr )
+    {
+        LOG( logWARNING ) << "Frame recorder : readback still pending, frame " << m_frameCount
+                          << " dropped.";
+        ++m_frameCount;
+        return;
+    }
+
+    m_viewer->makeCurrent();
+    const int width  = int( texture->width() );
+    const int height = int( texture->height() );
+    if ( r.buffer == 0 ) { glGenBuffers( 1, &r.buffer ); }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, r.buffer );
+    if ( r.width != width || r.height != height )
+    { glBufferData( GL_PIXEL_PACK_BUFFER, 4 * width * height, nullptr, GL_STREAM_READ ); }
+    texture->bind();
+    GLint packAlignment;
+    glGetIntegerv( GL_PACK_ALIGNMENT, &packAlignment );
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+    // The transfer into a pixel buffer returns immediately.
+    glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+    glPixelStorei( GL_PACK_ALIGNMENT, packAlignment );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+    r.fence  = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, UnusedMask::GL_UNUSED_BIT );
+    r.width  = width;
+    r.height = height;
+    r.frame  = m_frameCount++;
+    m_next   = ( m_next + 1 ) % s_numBuffers;
+    glFlush();
+    m_viewer->doneCurrent();
+
+    if ( !m_pollTimer.isActive() ) { m_pollTimer.start(); }
+}
+
+void FrameRecorder::processReadbacks( bool wait ) {
+    m_viewer->makeCurrent();
+    bool pending = false;
+    // Oldest transfers first, to encode the frames in order.
+    for ( size_t i = 0; i < s_numBuffers; ++i )
+    {
+        Readback& r = m_readbacks[( m_next + i ) % s_numBuffers];
+        if ( r.fence == nullptr ) { continue; }
+
+        const auto sync = static_cast<GLsync>( r.fence );
+        const GLenum status =
+            glClientWaitSync( sync,
+                              wait ? SyncObjectMask::GL_SYNC_FLUSH_COMMANDS_BIT
+                                   : SyncObjectMask::GL_NONE_BIT,
+                              wait ? GLuint64( 1000000000 ) : GLuint64( 0 ) );
+        if ( status == GL_TIMEOUT_EXPIRED )
+        {
+            pending = true;
+            break;
+        }
+        glDeleteSync( sync );
+        r.fence = nullptr;
+
+        QImage image( r.width, r.height, QImage::Format_RGBA8888 );
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, r.buffer );
+        const void* data = glMapBufferRange(
+            GL_PIXEL_PACK_BUFFER, 0, 4 * r.width * r.height, MapBufferAccessMask::GL_MAP_READ_BIT );
+        if ( data != nullptr )
+        {
+            std::memcpy( image.bits(), data, size_t( 4 * r.width * r.height ) );
+            glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+        }
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+        if ( data == nullptr ) { continue; }
+
+        // Bounded queue : wait for an encoder when they fall behind.
+        m_encoderSlots.acquire();
+        const QString filename =
+            QDir( m_outputFolder )
+                .filePath( QString( "radiumframe_%1.png" ).arg( r.frame, 6, 10, QChar( '0' ) ) );
+        m_encoders.start( new ImageEncoder( std::move( image ), filename, m_encoderSlots ) );
+    }
+    m_viewer->doneCurrent();
+
+    if ( !pending ) { m_pollTimer.stop(); }
+}
+
+void FrameRecorder::releaseBuffers() {
+    processReadbacks( true );
+    m_viewer->makeCurrent();
+    for ( auto& r : m_readbacks )
+    {
+        if ( r.buffer != 0 ) { glDeleteBuffers( 1, &r.buffer ); }
+        r = Readback();
+    }
+    m_viewer->doneCurrent();
+    m_next = 0;
+}
+
+} // namespace Ra
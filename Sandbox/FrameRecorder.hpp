@@ -0,0 +1,88 @@
+#ifndef RADIUMENGINE_FRAMERECORDER_HPP
+#define RADIUMENGINE_FRAMERECORDER_HPP
+
+#include <QObject>
+#include <QSemaphore>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <array>
+
+namespace Ra {
+namespace Gui {
+class Viewer;
+} // namespace Gui
+} // namespace Ra
+
+namespace Ra {
+
+/// Save the rendered frames to image files without stalling the rendering.
+///
+/// Frames are read back from the renderer display texture into a ring of pixel buffer objects
+/// and only mapped once the GPU finished the transfer, a few frames later. Images are then
+/// encoded on a thread pool. The number of images waiting to be encoded is bounded : when the
+/// encoders fall behind, the rendering waits for a free slot instead of accumulating frames in
+/// memory. A frame is dropped, and logged, if the oldest transfer is still not complete after
+/// waiting for it.
+class FrameRecorder : public QObject
+{
+    Q_OBJECT
+
+  public:
+    FrameRecorder( Gui::Viewer* viewer, QObject* parent = nullptr );
+    ~FrameRecorder() override;
+
+    /// Folder the images are written to.
+    void setOutputFolder( const QString& folder ) { m_outputFolder = folder; }
+
+  public slots:
+    /// Record every rendered frame, or stop recording.
+    void setRecording( bool recording );
+
+    /// Record the last rendered frame.
+    void snapshot();
+
+    /// To call after each rendered frame.
+    void onFrameComplete();
+
+  private slots:
+    /// Encode the frames whose transfer is complete.
+    /// \param wait Wait for the pending transfers instead of leaving them for later.
+    void processReadbacks( bool wait = false );
+
+  private:
+    /// Start the transfer of the current display texture into the next buffer of the ring.
+    void readback();
+    void releaseBuffers();
+
+    struct Readback {
+        uint buffer{0};
+        /// Fence of the transfer, null when the buffer is free.
+        void* fence{nullptr};
+        int width{0};
+        int height{0};
+        int frame{0};
+    };
+
+    Gui::Viewer* m_viewer;
+    QString m_outputFolder;
+    bool m_recording{false};
+    int m_frameCount{0};
+
+    static constexpr size_t s_numBuffers{3};
+    std::array<Readback, s_numBuffers> m_readbacks;
+    /// Next buffer of the ring.
+    size_t m_next{0};
+
+    QThreadPool m_encoders;
+    /// Free slots of the encoding queue.
+    QSemaphore m_encoderSlots;
+    static constexpr int s_maxPendingImages{8};
+    /// Drains the transfers when no new frame is rendered.
+    QTimer m_pollTimer;
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_FRAMERECORDER_HPP
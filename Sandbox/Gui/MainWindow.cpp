@@ -1,5 +1,6 @@
 #include <Gui/MainWindow.hpp>
 #include <MainApplication.hpp>
+#include <MeshMerger.hpp>
 
 #include <Core/Asset/FileLoaderInterface.hpp>
 #include <Engine/Scene/Entity.hpp>
@@ -29,10 +30,16 @@
 #include <QColorDialog>
 #include <QComboBox>
 #include <QFileDialog>
+#include <QMouseEvent>
 #include <QPushButton>
 #include <QSettings>
+#include <QTimer>
 #include <QToolButton>
 
+#include <algorithm>
+#include <set>
+#include <typeinfo>
+
 using Ra::Engine::Scene::ItemEntry;
 
 namespace Ra {
@@ -55,6 +62,10 @@ MainWindow::MainWindow( QWidget* parent ) : MainWindowInterface( parent ) {
     connect( m_viewer, &Viewer::rendererReady, this, &MainWindow::onRendererReady );
 
     m_viewer->setObjectName( QStringLiteral( "m_viewer" ) );
+    m_viewer->installEventFilter( this );
+    m_shaderWatcher = new ShaderWatcher( m_viewer, this );
+    m_frameRecorder = new FrameRecorder( m_viewer, this );
+    m_frameRecorder->setOutputFolder( QString::fromStdString( mainApp->getExportFolderName() ) );
 
     QWidget* viewerwidget = QWidget::createWindowContainer( m_viewer );
     //  viewerwidget->setMinimumSize( QSize( 800, 600 ) );
@@ -74,6 +85,8 @@ MainWindow::MainWindow( QWidget* parent ) : MainWindowInterface( parent ) {
     headers << tr( "Entities -> Components" );
     m_itemModel = new Gui::ItemModel( mainApp->getEngine(), this );
     m_entitiesTreeView->setModel( m_itemModel );
+    // All rows have the same height, so the view only lays out the rows it displays.
+    m_entitiesTreeView->setUniformRowHeights( true );
     m_materialEditor   = std::make_unique<MaterialEditor>();
     m_selectionManager = new Gui::SelectionManager( m_itemModel, this );
     m_entitiesTreeView->setSelectionModel( m_selectionManager );
@@ -109,9 +122,23 @@ void MainWindow::activateFlightManipulator() {
 // Connection to gizmos must be done after GL is initialized
 void MainWindow::createConnections() {
     connect( actionOpenMesh, &QAction::triggered, this, &MainWindow::loadFile );
-    connect( actionReload_Shaders, &QAction::triggered, m_viewer, &Viewer::reloadShaders );
+    connect( actionReload_Shaders,
+             &QAction::triggered,
+             m_shaderWatcher,
+             &ShaderWatcher::reloadModifiedShaders );
+    connect( actionReload_All_Shaders,
+             &QAction::triggered,
+             m_shaderWatcher,
+             &ShaderWatcher::reloadAllShaders );
+    connect( actionWatch_Shaders, &QAction::toggled, m_shaderWatcher, &ShaderWatcher::setEnabled );
+    connect( m_shaderWatcher,
+             &ShaderWatcher::shadersReloaded,
+             mainApp,
+             &Ra::Gui::BaseApplication::askForUpdate );
     connect(
         actionOpen_Material_Editor, &QAction::triggered, this, &MainWindow::openMaterialEditor );
+    connect( actionMerge_By_Material, &QAction::triggered, this, &MainWindow::mergeByMaterial );
+    connect( actionRevert_Merges, &QAction::triggered, this, &MainWindow::revertMerges );
 
     connect( actionFlight, &QAction::triggered, this, &MainWindow::activateFlightManipulator );
     connect(
@@ -131,8 +158,10 @@ void MainWindow::createConnections() {
     connect( actionGizmoRotate, &QAction::triggered, this, &MainWindow::gizmoShowRotate );
     connect( actionGizmoScale, &QAction::triggered, this, &MainWindow::gizmoShowScale );
 
-    connect( actionSnapshot, &QAction::triggered, mainApp, &MainApplication::recordFrame );
-    connect( actionRecord_Frames, &QAction::toggled, mainApp, &MainApplication::setRecordFrames );
+    // Frames are read back and encoded asynchronously instead of by the application.
+    connect( actionSnapshot, &QAction::triggered, m_frameRecorder, &FrameRecorder::snapshot );
+    connect(
+        actionRecord_Frames, &QAction::toggled, m_frameRecorder, &FrameRecorder::setRecording );
 
     connect(
         actionReload_configuration, &QAction::triggered, this, &MainWindow::reloadConfiguration );
@@ -163,6 +192,9 @@ void MainWindow::createConnections() {
     // Connect picking results (TODO Val : use events to dispatch picking directly)
     connect( m_viewer, &Viewer::toggleBrushPicking, this, &MainWindow::toggleCirclePicking );
     connect( m_viewer, &Viewer::rightClickPicking, this, &MainWindow::handlePicking );
+    connect( actionCPU_Picking, &QAction::toggled, [this]( bool on ) {
+        if ( on ) { m_picker.update(); }
+    } );
     // leftClickPicking is obsolete with the new input manager
 
     connect( m_avgFramesCount,
@@ -195,11 +227,13 @@ void MainWindow::createConnections() {
     connect(
         m_itemModel, &Gui::ItemModel::visibilityROChanged, this, &MainWindow::setROVisible );
     connect( m_editRenderObjectButton, &QPushButton::clicked, this, &MainWindow::editRO );
-    connect( m_exportMeshButton, &QPushButton::clicked, this, &MainWindow::exportCurrentMesh );
-    connect( m_removeEntityButton, &QPushButton::clicked, this, &MainWindow::deleteCurrentItem );
+    connect( m_exportMeshButton, &QPushButton::clicked, this, &MainWindow::exportSelectedMeshes );
+    connect( m_removeEntityButton, &QPushButton::clicked, this, &MainWindow::deleteSelectedItems );
     connect( m_clearSceneButton, &QPushButton::clicked, this, &MainWindow::resetScene );
     connect( m_fitCameraButton, &QPushButton::clicked, this, &MainWindow::fitCamera );
     connect( m_showHideAllButton, &QPushButton::clicked, this, &MainWindow::showHideAllRO );
+    connect(
+        m_showHideSelectedButton, &QPushButton::clicked, this, &MainWindow::showHideSelectedRO );
 
     // Renderer stuff
     connect(
@@ -292,13 +326,29 @@ void MainWindow::onUpdateFramestats( const std::vector<FrameTimerData>& stats )
                             .arg( stats.back().numFrame );
     m_frameA2BLabel->setText( framesA2B );
 
-    auto romgr = mainApp->m_engine->getRenderObjectManager();
-
-    auto polycount   = romgr->getNumFaces();
-    auto vertexcount = romgr->getNumVertices();
+    // Objects culled by the renderer are part of the visible ones.
+    size_t culledCount  = 0;
+    GeometryCount drawn = m_visibleGeometry;
+    if ( m_cullingRenderer != nullptr &&
+         m_currentRendererCombo->currentIndex() == m_cullingRendererIndex )
+    {
+        culledCount    = m_cullingRenderer->getCulledCount();
+        drawn.faces    = drawn.faces - std::min( drawn.faces, m_cullingRenderer->getCulledFaces() );
+        drawn.vertices = drawn.vertices -
+                         std::min( drawn.vertices, m_cullingRenderer->getCulledVertices() );
+    }
 
-    QString polyCountText =
-        QString( "Rendering %1 faces and %2 vertices" ).arg( polycount ).arg( vertexcount );
+    QString polyCountText = QString( "Rendering %1 faces and %2 vertices\n"
+                                     "Visible : %3 faces and %4 vertices\n"
+                                     "Scene : %5 faces and %6 vertices\n"
+                                     "Culled : %7 objects" )
+                                .arg( drawn.faces )
+                                .arg( drawn.vertices )
+                                .arg( m_visibleGeometry.faces )
+                                .arg( m_visibleGeometry.vertices )
+                                .arg( m_totalGeometry.faces )
+                                .arg( m_totalGeometry.vertices )
+                                .arg( culledCount );
     m_labelCount->setText( polyCountText );
 
     long sumRender     = 0;
@@ -348,7 +398,43 @@ void Gui::MainWindow::toggleCirclePicking( bool on ) {
 }
 
 void MainWindow::handlePicking( const Engine::Rendering::Renderer::PickingResult& pickingResult ) {
-    Ra::Core::Utils::Index roIndex( pickingResult.m_roIdx );
+    selectPickedRenderObject( Ra::Core::Utils::Index( pickingResult.m_roIdx ) );
+}
+
+void MainWindow::handleCPUPicking( const QPoint& position ) {
+    const Scalar ratio = Scalar( m_viewer->devicePixelRatio() );
+    const auto ray     = m_viewer->getCameraManipulator()->getCamera()->getRayFromScreen(
+        Core::Vector2( Scalar( position.x() ) * ratio, Scalar( position.y() ) * ratio ) );
+    const auto hit = m_picker.pick( ray );
+    if ( hit.isValid() )
+    {
+        auto ro = mainApp->m_engine->getRenderObjectManager()->getRenderObject( hit.roIndex );
+        _statusBar->showMessage( QString( "Picked %1, triangle %2" )
+                                     .arg( QString::fromStdString( ro->getName() ) )
+                                     .arg( hit.triangleIndex ),
+                                 2000 );
+    }
+    selectPickedRenderObject( hit.roIndex );
+}
+
+bool MainWindow::eventFilter( QObject* watched, QEvent* event ) {
+    if ( watched == m_viewer && event->type() == QEvent::MouseButtonPress &&
+         actionCPU_Picking->isChecked() )
+    {
+        // Plain right clicks only, modifiers select the GPU feature picking modes.
+        auto mouseEvent = static_cast<QMouseEvent*>( event );
+        if ( mouseEvent->button() == Qt::RightButton &&
+             mouseEvent->modifiers() == Qt::NoModifier )
+        {
+            handleCPUPicking( mouseEvent->pos() );
+            return true;
+        }
+    }
+    return MainWindowInterface::eventFilter( watched, event );
+}
+
+void MainWindow::selectPickedRenderObject( Core::Utils::Index roIndex ) {
+    flushPendingItems();
     Ra::Engine::RadiumEngine* engine = Ra::Engine::RadiumEngine::getInstance();
     if ( roIndex.isValid() )
     {
@@ -384,7 +470,7 @@ void MainWindow::onSelectionChanged( const QItemSelection& /*selected*/,
         {
             m_editRenderObjectButton->setEnabled( true );
 
-            m_materialEditor->changeRenderObject( ent.m_roIndex );
+            m_materialEditor->changeRenderObjects( getSelectedROs() );
             auto material = mainApp->m_engine->getRenderObjectManager()
                                 ->getRenderObject( ent.m_roIndex )
                                 ->getMaterial();
@@ -514,7 +600,7 @@ void MainWindow::changeRenderObjectShader( const QString& shaderName ) {
         const Engine::Data::ShaderConfiguration config =
             Ra::Engine::Data::ShaderConfigurationFactory::getConfiguration( name );
 
-        auto vector_of_ros = getItemROs( mainApp->m_engine.get(), item );
+        auto vector_of_ros = getItemROs( mainApp->getEngine(), item );
         for ( const auto& ro_index : vector_of_ros )
         {
             const auto& ro = mainApp->m_engine->getRenderObjectManager()->getRenderObject( ro_index
@@ -530,7 +616,69 @@ void MainWindow::changeRenderObjectShader( const QString& shaderName ) {
 }
 
 void Gui::MainWindow::setROVisible( Core::Utils::Index roIndex, bool visible ) {
+    if ( visible && getMergedSources().count( roIndex ) > 0 )
+    {
+        LOG( logINFO ) << "This object is displayed by a merged entity, revert the merges to "
+                          "show it.";
+        setROsVisible( {roIndex}, false );
+        return;
+    }
     mainApp->m_engine->getRenderObjectManager()->getRenderObject( roIndex )->setVisible( visible );
+    updateROVisibility( roIndex, visible );
+    mainApp->askForUpdate();
+}
+
+void Gui::MainWindow::updateROVisibility( Core::Utils::Index roIndex, bool visible ) {
+    auto it = m_roVisibility.find( roIndex );
+    if ( it == m_roVisibility.end() || it->second == visible ) { return; }
+
+    it->second           = visible;
+    const auto& geometry = m_roGeometry[roIndex];
+    if ( visible )
+    {
+        ++m_visibleROCount;
+        m_visibleGeometry.faces += geometry.faces;
+        m_visibleGeometry.vertices += geometry.vertices;
+    }
+    else
+    {
+        --m_visibleROCount;
+        m_visibleGeometry.faces -= geometry.faces;
+        m_visibleGeometry.vertices -= geometry.vertices;
+    }
+}
+
+void Gui::MainWindow::setROsVisible( const std::set<Core::Utils::Index>& roIndices,
+                                      bool visible ) {
+    auto romgr = mainApp->m_engine->getRenderObjectManager();
+    for ( const auto& roIndex : roIndices )
+    {
+        auto it = m_roVisibility.find( roIndex );
+        if ( it == m_roVisibility.end() || it->second == visible ) { continue; }
+        romgr->getRenderObject( roIndex )->setVisible( visible );
+        updateROVisibility( roIndex, visible );
+    }
+
+    // Render objects are the third level of the model : entities, components, render objects.
+    {
+        const QSignalBlocker blocker( m_itemModel );
+        for ( int i = 0; i < m_itemModel->rowCount(); ++i )
+        {
+            const auto entityIndex = m_itemModel->index( i, 0 );
+            for ( int j = 0; j < m_itemModel->rowCount( entityIndex ); ++j )
+            {
+                const auto componentIndex = m_itemModel->index( j, 0, entityIndex );
+                for ( int k = 0; k < m_itemModel->rowCount( componentIndex ); ++k )
+                {
+                    const auto idx  = m_itemModel->index( k, 0, componentIndex );
+                    const auto item = m_itemModel->getEntry( idx );
+                    if ( item.isRoNode() && roIndices.find( item.m_roIndex ) != roIndices.end() )
+                    { m_itemModel->setData( idx, visible, Qt::CheckStateRole ); }
+                }
+            }
+        }
+    }
+    m_entitiesTreeView->viewport()->update();
     mainApp->askForUpdate();
 }
 
@@ -538,39 +686,130 @@ void Gui::MainWindow::editRO() {
     ItemEntry item = m_selectionManager->currentItem();
     if ( item.isRoNode() )
     {
-        m_materialEditor->changeRenderObject( item.m_roIndex );
+        m_materialEditor->changeRenderObjects( getSelectedROs() );
         m_materialEditor->show();
     }
 }
 
+std::vector<ItemEntry> Gui::MainWindow::getSelectedItems() const {
+    std::vector<ItemEntry> items;
+    for ( const auto& idx : m_selectionManager->selectedIndexes() )
+    {
+        const ItemEntry item = m_itemModel->getEntry( idx );
+        if ( item.isValid() ) { items.push_back( item ); }
+    }
+    return items;
+}
+
+std::vector<Core::Utils::Index> Gui::MainWindow::getSelectedROs() const {
+    // The current item comes first, it is the one displayed by the editors.
+    std::vector<Core::Utils::Index> roIndices;
+    const ItemEntry current = m_selectionManager->currentItem();
+    if ( current.isRoNode() ) { roIndices.push_back( current.m_roIndex ); }
+    for ( const auto& item : getSelectedItems() )
+    {
+        if ( item.isRoNode() && item.m_roIndex != current.m_roIndex )
+        { roIndices.push_back( item.m_roIndex ); }
+    }
+    return roIndices;
+}
+
 void Gui::MainWindow::showHideAllRO() {
-    bool allEntityInvisible = true;
+    // if all entities are invisible : show all
+    // if at least one entity is visible : hide all
+    setAllROVisible( m_visibleROCount == 0 );
+}
+
+void Gui::MainWindow::setAllROVisible( bool visible ) {
+    flushPendingItems();
 
-    const int j = 0;
-    for ( int i = 0; i < m_itemModel->rowCount(); ++i )
+    // Update the check state of the model without notifying each row : visibility is applied
+    // below in a single pass on the render objects.
     {
-        auto idx  = m_itemModel->index( i, j );
-        auto item = m_itemModel->getEntry( idx );
-        if ( item.isValid() && item.isSelectable() )
+        const QSignalBlocker blocker( m_itemModel );
+        const int j = 0;
+        for ( int i = 0; i < m_itemModel->rowCount(); ++i )
         {
-            bool isVisible = m_itemModel->data( idx, Qt::CheckStateRole ).toBool();
-            if ( isVisible )
-            {
-                allEntityInvisible = false;
-                break;
-            }
+            auto idx  = m_itemModel->index( i, j );
+            auto item = m_itemModel->getEntry( idx );
+            if ( item.isValid() && item.isSelectable() )
+            { m_itemModel->setData( idx, visible, Qt::CheckStateRole ); }
         }
     }
 
-    // if all entities are invisible : show all
-    // if at least one entity is visible : hide all
-    for ( int i = 0; i < m_itemModel->rowCount(); ++i )
+    // Merged objects stay hidden, their merged copy is displayed instead.
+    const auto merged = visible ? getMergedSources() : std::set<Core::Utils::Index>();
+    auto romgr        = mainApp->m_engine->getRenderObjectManager();
+    for ( auto& ro : m_roVisibility )
+    {
+        const bool roVisible = visible && merged.find( ro.first ) == merged.end();
+        if ( ro.second != roVisible )
+        {
+            romgr->getRenderObject( ro.first )->setVisible( roVisible );
+            ro.second = roVisible;
+        }
+    }
+    m_visibleROCount  = visible ? m_roVisibility.size() - merged.size() : 0;
+    m_visibleGeometry = visible ? m_totalGeometry : GeometryCount();
+    for ( const auto& roIndex : merged )
+    {
+        m_visibleGeometry.faces -= m_roGeometry[roIndex].faces;
+        m_visibleGeometry.vertices -= m_roGeometry[roIndex].vertices;
+    }
+    if ( !merged.empty() ) { setROsVisible( merged, false ); }
+
+    const int rows = m_itemModel->rowCount();
+    if ( rows > 0 )
+    {
+        emit m_itemModel->dataChanged(
+            m_itemModel->index( 0, 0 ), m_itemModel->index( rows - 1, 0 ), {Qt::CheckStateRole} );
+    }
+    m_entitiesTreeView->viewport()->update();
+    mainApp->askForUpdate();
+}
+
+void Gui::MainWindow::showHideSelectedRO() {
+    // Merged objects stay hidden, their merged copy is displayed instead.
+    const auto merged = getMergedSources();
+    std::set<Core::Utils::Index> roIndices;
+    std::set<Core::Utils::Index> selectedMerged;
+    for ( const auto& item : getSelectedItems() )
     {
-        auto idx  = m_itemModel->index( i, j );
-        auto item = m_itemModel->getEntry( idx );
-        if ( item.isValid() && item.isSelectable() )
-        { m_itemModel->setData( idx, allEntityInvisible, Qt::CheckStateRole ); }
+        for ( const auto& roIndex : getItemROs( mainApp->getEngine(), item ) )
+        {
+            if ( merged.find( roIndex ) != merged.end() ) { selectedMerged.insert( roIndex ); }
+            else if ( m_roVisibility.find( roIndex ) != m_roVisibility.end() )
+            { roIndices.insert( roIndex ); }
+        }
     }
+    if ( roIndices.empty() ) { return; }
+
+    // if at least one selected object is visible : hide the selection
+    const bool visible = std::none_of( roIndices.begin(), roIndices.end(), [this]( auto roIndex ) {
+        return m_roVisibility[roIndex];
+    } );
+
+    // Same as setAllROVisible : the check states are updated silently and the render objects
+    // are changed in a single pass.
+    {
+        const QSignalBlocker blocker( m_itemModel );
+        for ( const auto& idx : m_selectionManager->selectedIndexes() )
+        {
+            m_itemModel->setData( idx, visible, Qt::CheckStateRole );
+        }
+    }
+
+    auto romgr = mainApp->m_engine->getRenderObjectManager();
+    for ( const auto& roIndex : roIndices )
+    {
+        if ( m_roVisibility[roIndex] != visible )
+        {
+            romgr->getRenderObject( roIndex )->setVisible( visible );
+            updateROVisibility( roIndex, visible );
+        }
+    }
+    if ( visible && !selectedMerged.empty() ) { setROsVisible( selectedMerged, false ); }
+    m_entitiesTreeView->viewport()->update();
     mainApp->askForUpdate();
 }
 
@@ -604,6 +843,17 @@ void MainWindow::onRendererReady() {
 }
 
 void MainWindow::onFrameComplete() {
+    m_frameRecorder->onFrameComplete();
+    applyPendingRemovals();
+    flushPendingItems();
+    // Objects of the removed merged entities are shown once the item model is up to date.
+    if ( !m_unmergedROs.empty() )
+    {
+        setROsVisible( m_unmergedROs, true );
+        m_unmergedROs.clear();
+    }
+    // Keep the picking hierarchies in sync with the displayed frame, off the click path.
+    if ( actionCPU_Picking->isChecked() ) { m_picker.update(); }
     tab_edition->updateValues();
     // update timeline only if time changed, to allow manipulation of keyframed objects
     auto engine = Ra::Engine::RadiumEngine::getInstance();
@@ -678,28 +928,142 @@ void MainWindow::timelineSetPingPong( bool status ) {
 }
 
 void MainWindow::onItemAdded( const Engine::Scene::ItemEntry& ent ) {
-    m_itemModel->addItem( ent );
+    if ( ent.isRoNode() ) { m_roWithoutTechnique.insert( ent.m_roIndex ); }
+    if ( ent.isRoNode() && ent.isSelectable() )
+    {
+        auto ro =
+            mainApp->m_engine->getRenderObjectManager()->getRenderObject( ent.m_roIndex );
+        const bool visible            = ro->isVisible();
+        m_roVisibility[ent.m_roIndex] = false;
+
+        GeometryCount geometry;
+        if ( ro->getMesh() != nullptr )
+        {
+            geometry.faces    = ro->getMesh()->getNumFaces();
+            geometry.vertices = ro->getMesh()->getNumVertices();
+        }
+        m_roGeometry[ent.m_roIndex] = geometry;
+        m_totalGeometry.faces += geometry.faces;
+        m_totalGeometry.vertices += geometry.vertices;
+        updateROVisibility( ent.m_roIndex, visible );
+
+        m_aabbCache.addRenderObject( ro );
+        m_picker.addRenderObject( ro );
+    }
+
+    // Items are inserted in the model once per frame, or as soon as the event loop is idle
+    // when no frame is pending.
+    if ( m_pendingItems.empty() )
+    { QTimer::singleShot( 0, this, &MainWindow::flushPendingItems ); }
+    m_pendingItems.push_back( ent );
 }
 
 void MainWindow::onItemRemoved( const Engine::Scene::ItemEntry& ent ) {
-    m_itemModel->removeItem( ent );
+    if ( m_clearingScene ) { return; }
+    if ( ent.isRoNode() )
+    {
+        m_roWithoutTechnique.erase( ent.m_roIndex );
+        auto it = m_roVisibility.find( ent.m_roIndex );
+        if ( it != m_roVisibility.end() )
+        {
+            updateROVisibility( ent.m_roIndex, false );
+            const auto& geometry = m_roGeometry[ent.m_roIndex];
+            m_totalGeometry.faces -= geometry.faces;
+            m_totalGeometry.vertices -= geometry.vertices;
+            m_roGeometry.erase( ent.m_roIndex );
+            m_roVisibility.erase( it );
+        }
+        m_aabbCache.removeRenderObject( ent.m_roIndex );
+        m_picker.removeRenderObject( ent.m_roIndex );
+        for ( auto& merge : m_mergedROs )
+        {
+            merge.second.erase( ent.m_roIndex );
+        }
+        m_unmergedROs.erase( ent.m_roIndex );
+    }
+    else if ( ent.isEntityNode() )
+    {
+        // Removing a merged entity reverts the merge, at the end of the frame.
+        auto merge = m_mergedROs.find( ent.m_entity );
+        if ( merge != m_mergedROs.end() )
+        {
+            m_unmergedROs.insert( merge->second.begin(), merge->second.end() );
+            m_mergedROs.erase( merge );
+            mainApp->askForUpdate();
+        }
+    }
+
+    // Queued removals must not refer to an item that no longer exists.
+    if ( !m_pendingRemovals.empty() )
+    {
+        auto removed = [&ent]( const ItemEntry& e ) {
+            if ( ent.isEntityNode() ) { return e.m_entity == ent.m_entity; }
+            if ( ent.isComponentNode() ) { return e.m_component == ent.m_component; }
+            return e.isRoNode() && e.m_roIndex == ent.m_roIndex;
+        };
+        m_pendingRemovals.erase(
+            std::remove_if( m_pendingRemovals.begin(), m_pendingRemovals.end(), removed ),
+            m_pendingRemovals.end() );
+    }
+
+    auto pending = std::find( m_pendingItems.begin(), m_pendingItems.end(), ent );
+    if ( pending != m_pendingItems.end() )
+    {
+        // never reached the model
+        m_pendingItems.erase( pending );
+        return;
+    }
+    flushPendingItems();
+    if ( !m_deferItemRemoval ) { m_itemModel->removeItem( ent ); }
+}
+
+void MainWindow::flushPendingItems() {
+    if ( m_pendingItems.empty() ) { return; }
+
+    if ( m_pendingItems.size() > s_itemModelRebuildThreshold )
+    {
+        // One model reset is much cheaper than thousands of row insertions.
+        m_itemModel->rebuildModel();
+    }
+    else
+    {
+        m_entitiesTreeView->setUpdatesEnabled( false );
+        for ( const auto& ent : m_pendingItems )
+        {
+            m_itemModel->addItem( ent );
+        }
+        m_entitiesTreeView->setUpdatesEnabled( true );
+    }
+    m_pendingItems.clear();
 }
 
-void MainWindow::exportCurrentMesh() {
+void MainWindow::exportSelectedMeshes() {
     std::stringstream filenameStream;
     filenameStream << mainApp->getExportFolderName() << "/radiummesh_" << std::setw( 6 )
                    << std::setfill( '0' ) << mainApp->getFrameCount();
-    std::string filename = filenameStream.str();
-
-    ItemEntry e = m_selectionManager->currentItem();
+    const std::string basename = filenameStream.str();
 
     // For now we only export a mesh if the selected entry is a render object.
     // There could be a virtual method to get a mesh representation for any object.
-    if ( e.isRoNode() )
+    std::vector<Core::Utils::Index> roIndices;
+    for ( const auto& e : getSelectedItems() )
     {
-        Ra::IO::OBJFileManager obj;
-        auto ro = Engine::RadiumEngine::getInstance()->getRenderObjectManager()->getRenderObject(
-            e.m_roIndex );
+        if ( e.isRoNode() ) { roIndices.push_back( e.m_roIndex ); }
+    }
+    if ( roIndices.empty() )
+    {
+        LOG( logWARNING ) << "No render object selected. No mesh was exported.";
+        return;
+    }
+
+    Ra::IO::OBJFileManager obj;
+    auto romgr = Engine::RadiumEngine::getInstance()->getRenderObjectManager();
+    for ( size_t i = 0; i < roIndices.size(); ++i )
+    {
+        std::string filename = basename;
+        if ( roIndices.size() > 1 ) { filename += "_" + std::to_string( i ); }
+
+        auto ro = romgr->getRenderObject( roIndices[i] );
         const std::shared_ptr<Engine::Data::Displayable>& displ = ro->getMesh();
         const Engine::Data::Mesh* mesh = dynamic_cast<Engine::Data::Mesh*>( displ.get() );
 
@@ -711,12 +1075,34 @@ void MainWindow::exportCurrentMesh() {
         else
         { LOG( logERROR ) << "Mesh from " << ro->getName() << "failed to export"; }
     }
-    else
-    { LOG( logWARNING ) << "Current entry was not a render object. No mesh was exported."; }
 }
 
-void MainWindow::deleteCurrentItem() {
-    ItemEntry e = m_selectionManager->currentItem();
+void MainWindow::deleteSelectedItems() {
+    std::vector<ItemEntry> items = getSelectedItems();
+    if ( items.empty() ) { return; }
+
+    // The engine tasks and the renderer may be using the render objects : they are removed
+    // between two frames, when nobody else holds the render object manager.
+    m_selectionManager->clear();
+    if ( m_pendingRemovals.empty() ) { mainApp->askForUpdate(); }
+    m_pendingRemovals.insert( m_pendingRemovals.end(), items.begin(), items.end() );
+}
+
+void MainWindow::applyPendingRemovals() {
+    if ( m_pendingRemovals.empty() ) { return; }
+    std::vector<ItemEntry> items;
+    std::swap( items, m_pendingRemovals );
+
+    // An item is removed with its parent : items whose entity or component is also selected
+    // must be skipped, their entry would be dangling once the parent is removed.
+    std::set<const Engine::Scene::Entity*> entities;
+    std::set<const Engine::Scene::Component*> components;
+    for ( const auto& e : items )
+    {
+        if ( e.isEntityNode() ) { entities.insert( e.m_entity ); }
+        else if ( e.isComponentNode() )
+        { components.insert( e.m_component ); }
+    }
 
     // This call is very important to avoid a potential race condition
     // which happens if an object is selected while a gizmo is present.
@@ -726,28 +1112,181 @@ void MainWindow::deleteCurrentItem() {
     // the object we want to delete, which causes a deadlock.
     // Clearing the selection before deleting the object will avoid this problem.
     m_selectionManager->clear();
-    if ( e.isRoNode() ) { e.m_component->removeRenderObject( e.m_roIndex ); }
-    else if ( e.isComponentNode() )
-    { e.m_entity->removeComponent( e.m_component->getName() ); }
-    else if ( e.isEntityNode() )
+    flushPendingItems();
+
+    // Large batches rebuild the model once, small ones remove their rows without repainting
+    // the tree between two removals.
+    m_deferItemRemoval = items.size() > s_itemModelRebuildThreshold;
+    m_entitiesTreeView->setUpdatesEnabled( false );
+
+    // The same item may have been queued several times.
+    std::set<const Engine::Scene::Entity*> removedEntities;
+    std::set<const Engine::Scene::Component*> removedComponents;
+    std::set<Core::Utils::Index> removedROs;
+    for ( const auto& e : items )
     {
-        Engine::RadiumEngine::getInstance()->getEntityManager()->removeEntity(
-            e.m_entity->getIndex() );
+        const bool entitySelected = entities.find( e.m_entity ) != entities.end();
+        if ( e.isRoNode() )
+        {
+            if ( !entitySelected && components.find( e.m_component ) == components.end() &&
+                 removedROs.insert( e.m_roIndex ).second )
+            { e.m_component->removeRenderObject( e.m_roIndex ); }
+        }
+        else if ( e.isComponentNode() )
+        {
+            if ( !entitySelected && removedComponents.insert( e.m_component ).second )
+            { e.m_entity->removeComponent( e.m_component->getName() ); }
+        }
+        else if ( e.isEntityNode() )
+        {
+            if ( removedEntities.insert( e.m_entity ).second )
+            {
+                Engine::RadiumEngine::getInstance()->getEntityManager()->removeEntity(
+                    e.m_entity->getIndex() );
+            }
+        }
+    }
+    if ( m_deferItemRemoval )
+    {
+        m_itemModel->rebuildModel();
+        m_deferItemRemoval = false;
     }
+    m_entitiesTreeView->setUpdatesEnabled( true );
     mainApp->askForUpdate();
 }
 
+void MainWindow::mergeByMaterial() {
+    // Queued removals may refer to the merged render objects.
+    applyPendingRemovals();
+
+    auto romgr = mainApp->m_engine->getRenderObjectManager();
+    std::vector<std::shared_ptr<Engine::Rendering::RenderObject>> ros;
+    for ( const auto& ro : m_roVisibility )
+    {
+        if ( ro.second ) { ros.push_back( romgr->getRenderObject( ro.first ) ); }
+    }
+
+    if ( mergeRenderObjects( ros, "Merged objects" ) > 0 ) { buildPendingTechniques(); }
+    mainApp->askForUpdate();
+}
+
+void MainWindow::revertMerges() {
+    if ( m_mergedROs.empty() ) { return; }
+    if ( m_pendingRemovals.empty() ) { mainApp->askForUpdate(); }
+    for ( const auto& merge : m_mergedROs )
+    {
+        m_pendingRemovals.emplace_back( merge.first );
+    }
+}
+
+size_t MainWindow::mergeRenderObjects(
+    const std::vector<std::shared_ptr<Engine::Rendering::RenderObject>>& ros,
+    const std::string& entityName ) {
+    std::vector<std::shared_ptr<Engine::Rendering::RenderObject>> merged;
+    auto entity = MeshMerger::mergeByMaterial( ros, entityName, merged );
+    if ( entity == nullptr ) { return 0; }
+
+    // The merged render objects are kept, hidden, so that the merge can be reverted.
+    std::set<Core::Utils::Index> roIndices;
+    for ( const auto& ro : merged )
+    {
+        roIndices.insert( ro->getIndex() );
+    }
+    flushPendingItems();
+    setROsVisible( roIndices, false );
+    m_mergedROs[entity] = std::move( roIndices );
+
+    LOG( logINFO ) << merged.size() << " render objects merged in " << entityName << ".";
+    return merged.size();
+}
+
+std::set<Core::Utils::Index> MainWindow::getMergedSources() const {
+    std::set<Core::Utils::Index> roIndices;
+    for ( const auto& merge : m_mergedROs )
+    {
+        roIndices.insert( merge.second.begin(), merge.second.end() );
+    }
+    return roIndices;
+}
+
+void MainWindow::buildPendingTechniques() {
+    if ( actionShared_Mesh_Arena->isChecked() ) { moveMeshesToArena(); }
+    // Shader programs shared with the objects already in the scene are reused by the
+    // ShaderProgramManager.
+    auto renderer = m_viewer->getRenderer();
+    auto romgr    = Engine::RadiumEngine::getInstance()->getRenderObjectManager();
+    for ( const auto& roIndex : m_roWithoutTechnique )
+    {
+        renderer->buildRenderTechnique( romgr->getRenderObject( roIndex ).get() );
+    }
+    m_roWithoutTechnique.clear();
+    m_shaderWatcher->updateWatchedFiles();
+}
+
+void MainWindow::moveMeshesToArena() {
+    if ( m_meshArena == nullptr ) { m_meshArena = std::make_shared<MeshArena>(); }
+    auto romgr   = Engine::RadiumEngine::getInstance()->getRenderObjectManager();
+    size_t count = 0;
+    for ( const auto& roIndex : m_roWithoutTechnique )
+    {
+        auto ro   = romgr->getRenderObject( roIndex );
+        auto mesh = ro->getMesh();
+        // Subclasses of Mesh, as the arena meshes themselves, draw in their own way.
+        if ( ro->getType() != Engine::Rendering::RenderObjectType::Geometry || mesh == nullptr ||
+             typeid( *mesh ) != typeid( Engine::Data::Mesh ) )
+        { continue; }
+
+        // The component keeps its mesh, whose buffers are never created as it is not drawn.
+        auto& geometry = static_cast<Engine::Data::Mesh*>( mesh.get() )->getCoreGeometry();
+        ro->setMesh( std::make_shared<ArenaMesh>(
+            mesh->getName(), Core::Geometry::TriangleMesh( geometry ), m_meshArena ) );
+        // The caches track the displayed mesh.
+        if ( m_roVisibility.find( roIndex ) != m_roVisibility.end() )
+        {
+            m_aabbCache.addRenderObject( ro );
+            m_picker.addRenderObject( ro );
+        }
+        ++count;
+    }
+    if ( count > 0 ) { LOG( logINFO ) << count << " meshes stored in the shared mesh arena."; }
+}
+
 void MainWindow::resetScene() {
     // Fix issue #378 : ask the viewer to switch back to the default camera
     m_viewer->getCameraManipulator()->resetToDefaultCamera();
-    // To see why this call is important, please see deleteCurrentItem().
+    // To see why this call is important, please see applyPendingRemovals().
     m_selectionManager->clear();
+
+    // Everything goes away : the caches are cleared wholesale instead of item by item, and the
+    // item model is reset once the entities are deleted.
+    m_pendingItems.clear();
+    m_pendingRemovals.clear();
+    m_roWithoutTechnique.clear();
+    m_mergedROs.clear();
+    m_unmergedROs.clear();
+    m_roVisibility.clear();
+    m_visibleROCount = 0;
+    m_roGeometry.clear();
+    m_totalGeometry   = GeometryCount();
+    m_visibleGeometry = GeometryCount();
+    m_picker.clear();
+    m_aabbCache.clear();
+
+    m_clearingScene = true;
+    m_entitiesTreeView->setUpdatesEnabled( false );
     Engine::RadiumEngine::getInstance()->getEntityManager()->deleteEntities();
-    fitCamera();
+    m_itemModel->rebuildModel();
+    m_entitiesTreeView->setUpdatesEnabled( true );
+    m_clearingScene = false;
+    m_shaderWatcher->updateWatchedFiles();
+
+    // The scene is empty, there is no bounding box to fit.
+    m_viewer->getCameraManipulator()->resetCamera();
+    mainApp->askForUpdate();
 }
 
 void MainWindow::fitCamera() {
-    auto aabb = Engine::RadiumEngine::getInstance()->computeSceneAabb();
+    auto aabb = m_aabbCache.computeSceneAabb();
     if ( aabb.isEmpty() )
     {
         m_viewer->getCameraManipulator()->resetCamera();
@@ -758,8 +1297,10 @@ void MainWindow::fitCamera() {
 }
 
 void MainWindow::postLoadFile( const std::string& filename ) {
-    m_viewer->getRenderer()->buildAllRenderTechniques();
+    // Only the render objects of the loaded file need a render technique.
+    buildPendingTechniques();
     m_selectionManager->clear();
+    flushPendingItems();
     m_currentShaderBox->clear();
     m_currentShaderBox->setEnabled( false );
     m_currentShaderBox->addItem( "" ); // add empty item
@@ -775,6 +1316,8 @@ void MainWindow::postLoadFile( const std::string& filename ) {
     }
 
     fitCamera();
+    // Build the picking hierarchies of the new meshes now rather than on the first click.
+    if ( actionCPU_Picking->isChecked() ) { m_picker.update(); }
 
     // TODO : find a better way to activate loaded camera
     // If a camera is in the loaded scene, use it, else, use default
@@ -811,8 +1354,9 @@ void MainWindow::onGLInitialized() {
         this, &MainWindow::selectedItem, m_viewer->getGizmoManager(), &GizmoManager::setEditable );
 
     // set default renderer once OpenGL is configured
-    std::shared_ptr<Engine::Rendering::Renderer> e( new Engine::Rendering::ForwardRenderer() );
-    addRenderer( "Forward Renderer", e );
+    m_cullingRenderer      = std::make_shared<CullingForwardRenderer>( m_aabbCache );
+    m_cullingRendererIndex = m_currentRendererCombo->count();
+    addRenderer( "Forward Renderer", m_cullingRenderer );
 }
 
 void MainWindow::addPluginPath() {
@@ -6,7 +6,13 @@
 #include <Gui/SelectionManager/SelectionManager.hpp>
 #include <Gui/TimerData/FrameTimerData.hpp>
 #include <Gui/TreeModel/EntityTreeModel.hpp>
+#include <CullingForwardRenderer.hpp>
+#include <FrameRecorder.hpp>
 #include <Gui/MaterialEditor.hpp>
+#include <MeshArena.hpp>
+#include <Picking/ScenePicker.hpp>
+#include <SceneAabbCache.hpp>
+#include <ShaderWatcher.hpp>
 
 #include "ui_MainWindow.h"
 #include <QMainWindow>
@@ -14,6 +20,11 @@
 #include <QEvent>
 #include <qdebug.h>
 
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
 namespace Ra {
 namespace Engine {
 class Entity;
@@ -107,6 +118,13 @@ class MainWindow : public Ra::Gui::MainWindowInterface, private Ui::MainWindow
     /// Show or hide all render objects
     void showHideAllRO();
 
+    /// Change the visibility of all the selectable render objects at once, with a single model
+    /// notification and a single redraw.
+    void setAllROVisible( bool visible );
+
+    /// Show or hide the render objects of the selected items
+    void showHideSelectedRO();
+
   signals:
     /// Emitted when the frame loads
     void fileLoading( const QString path );
@@ -126,6 +144,51 @@ class MainWindow : public Ra::Gui::MainWindowInterface, private Ui::MainWindow
 
     virtual void closeEvent( QCloseEvent* event ) override;
 
+    /// Intercepts the viewer right clicks when CPU picking is enabled.
+    bool eventFilter( QObject* watched, QEvent* event ) override;
+
+    /// Select the render object hit by a CPU ray cast at the given viewer position.
+    void handleCPUPicking( const QPoint& position );
+
+    /// Remove the items queued by deleteSelectedItems() in one batch, then update the item model
+    /// and request a redraw.
+    void applyPendingRemovals();
+
+    /// Update the visibility of a selectable render object in m_roVisibility and the visible
+    /// counters. The render object itself is not modified.
+    void updateROVisibility( Core::Utils::Index roIndex, bool visible );
+
+    /// Show or hide selectable render objects. Their check state is updated in a single pass on
+    /// the item model, without notifying each row.
+    void setROsVisible( const std::set<Core::Utils::Index>& roIndices, bool visible );
+
+    /// Merge render objects with MeshMerger, in a new entity. The merged render objects are
+    /// hidden, they are shown again when the new entity is removed.
+    /// Returns the number of merged render objects.
+    size_t mergeRenderObjects(
+        const std::vector<std::shared_ptr<Engine::Rendering::RenderObject>>& ros,
+        const std::string& entityName );
+
+    /// Render objects hidden by the merged entities. They stay hidden while their merged copy
+    /// is displayed, whatever the visibility actions.
+    std::set<Core::Utils::Index> getMergedSources() const;
+
+    /// Build the render techniques of the render objects added since the last call.
+    void buildPendingTechniques();
+
+    /// Replace the triangle meshes of the render objects without technique by meshes stored in
+    /// m_meshArena, before their GPU buffers are created.
+    void moveMeshesToArena();
+
+    /// Selected items, in selection order.
+    std::vector<Engine::Scene::ItemEntry> getSelectedItems() const;
+
+    /// Render objects of the selected items.
+    std::vector<Core::Utils::Index> getSelectedROs() const;
+
+    /// Select a picked render object, or clear the selection if the index is invalid.
+    void selectPickedRenderObject( Core::Utils::Index roIndex );
+
     /// Update displayed texture according to the current renderer
     void updateDisplayedTexture();
 
@@ -133,6 +196,9 @@ class MainWindow : public Ra::Gui::MainWindowInterface, private Ui::MainWindow
     /// QSettings.
     void updateBackgroundColor( QColor c = QColor() );
 
+    /// Insert the engine items created since the last call in the item model.
+    void flushPendingItems();
+
   private slots:
     /// Slot for the "load file" menu.
     void loadFile();
@@ -155,15 +221,23 @@ class MainWindow : public Ra::Gui::MainWindowInterface, private Ui::MainWindow
     /// Slot to accept a new renderer
     void onRendererReady();
 
-    /// Exports the mesh of the currently selected object to a file.
-    void exportCurrentMesh();
+    /// Exports the meshes of the selected objects to files.
+    void exportSelectedMeshes();
 
-    /// Remove the currently selected item (entity, component or ro)
-    void deleteCurrentItem();
+    /// Remove the selected items (entities, components or ros). The removal is queued and
+    /// applied at the end of the next frame.
+    void deleteSelectedItems();
 
     /// Clears all entities and resets the camera.
     void resetScene();
 
+    /// Merge the visible objects sharing the same material parameters, see MeshMerger.
+    void mergeByMaterial();
+
+    /// Remove the entities created by mergeByMaterial(), which shows the merged objects again.
+    /// The removal is queued like deleteSelectedItems().
+    void revertMerges();
+
     /// Allow to pick using a circle
     void toggleCirclePicking( bool on );
 
@@ -211,6 +285,77 @@ class MainWindow : public Ra::Gui::MainWindowInterface, private Ui::MainWindow
     /// Stores the internal model of engine objects for selection and visibility.
     Gui::ItemModel* m_itemModel{nullptr};
 
+    /// Engine items not yet inserted in the item model. They are inserted in one batch, at most
+    /// once per frame, instead of one model update per entity, component and render object.
+    std::vector<Engine::Scene::ItemEntry> m_pendingItems;
+
+    /// Above this number of pending items, the model is rebuilt instead of updated.
+    static constexpr size_t s_itemModelRebuildThreshold{256};
+
+    /// Set while removing a large batch of items : the model is rebuilt once afterwards instead
+    /// of removing the items one by one.
+    bool m_deferItemRemoval{false};
+
+    /// Items to remove at the end of the next frame. Entries referring to items removed in the
+    /// meantime are discarded by onItemRemoved.
+    std::vector<Engine::Scene::ItemEntry> m_pendingRemovals;
+
+    /// Set while the whole scene is deleted : the per item bookkeeping of onItemRemoved is
+    /// skipped, resetScene() clears everything at once.
+    bool m_clearingScene{false};
+
+    /// Visibility of the selectable render objects, kept up to date on add, remove and
+    /// visibility change so that show/hide-all does not have to query the model.
+    std::map<Core::Utils::Index, bool> m_roVisibility;
+
+    /// Number of visible render objects in m_roVisibility.
+    size_t m_visibleROCount{0};
+
+    /// Number of faces and vertices of a set of render objects.
+    struct GeometryCount {
+        size_t faces{0};
+        size_t vertices{0};
+    };
+
+    /// Geometry of the selectable render objects, and its sums over all of them and over the
+    /// visible ones. Kept up to date like m_roVisibility, the stats do not have to query each
+    /// render object.
+    std::map<Core::Utils::Index, GeometryCount> m_roGeometry;
+    GeometryCount m_totalGeometry;
+    GeometryCount m_visibleGeometry;
+
+    /// Cached bounding boxes of the selectable render objects, used to fit the camera.
+    SceneAabbCache m_aabbCache;
+
+    /// CPU ray caster over the selectable render objects.
+    Picking::ScenePicker m_picker{m_aabbCache};
+
+    /// Render objects hidden by each entity created by mergeRenderObjects(), shown again when
+    /// the entity is removed.
+    std::map<Engine::Scene::Entity*, std::set<Core::Utils::Index>> m_mergedROs;
+    /// Render objects of the merged entities removed during the frame, to show again.
+    std::set<Core::Utils::Index> m_unmergedROs;
+
+    /// Render objects added since the last loaded file, whose render techniques still have to
+    /// be built.
+    std::set<Core::Utils::Index> m_roWithoutTechnique;
+
+    /// Default renderer, culling the render objects outside of the view frustum.
+    std::shared_ptr<CullingForwardRenderer> m_cullingRenderer;
+
+    /// Index of m_cullingRenderer in the renderer list.
+    int m_cullingRendererIndex{-1};
+
+    /// Buffers shared by the meshes loaded with actionShared_Mesh_Arena checked, created with
+    /// the first of them. The meshes keep it alive.
+    std::shared_ptr<MeshArena> m_meshArena;
+
+    /// Reloads the shader programs whose files are modified.
+    ShaderWatcher* m_shaderWatcher{nullptr};
+
+    /// Saves the snapshots and recorded frames.
+    FrameRecorder* m_frameRecorder{nullptr};
+
     /// Stores and manages the current selection.
     Gui::SelectionManager* m_selectionManager{nullptr};
 
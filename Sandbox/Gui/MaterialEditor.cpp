@@ -7,6 +7,9 @@
 #include <Engine/Rendering/RenderTechnique.hpp>
 
 #include <QCloseEvent>
+#include <QTimer>
+
+#include <set>
 
 namespace Ra {
 namespace Gui {
@@ -55,39 +58,49 @@ MaterialEditor::MaterialEditor( QWidget* parent ) :
     setWindowTitle( "Material Editor" );
 }
 
-void MaterialEditor::updateEngine() {
-    m_blinnphongmaterial->needUpdate();
-    emit materialChanged();
+void MaterialEditor::scheduleUpdate( uint changes ) {
+    if ( !m_renderObject || !m_usable || m_blinnphongmaterials.empty() ) { return; }
+
+    if ( m_pendingChanges == 0 ) { QTimer::singleShot( 0, this, &MaterialEditor::updateEngine ); }
+    m_pendingChanges |= changes;
 }
 
-void MaterialEditor::onExpChanged( double v ) {
-    if ( m_renderObject && m_usable )
+void MaterialEditor::updateEngine() {
+    if ( m_pendingChanges == 0 ) { return; }
+
+    // Values are read from the widgets, only the modified parameters are written so that the
+    // other parameters of each material are kept.
+    const Core::Utils::Color kd(
+        kdR->value() / 255_ra, kdG->value() / 255_ra, kdB->value() / 255_ra, 1_ra );
+    const Core::Utils::Color ks(
+        ksR->value() / 255_ra, ksG->value() / 255_ra, ksB->value() / 255_ra, 1_ra );
+    const Scalar ns      = Scalar( exp->value() );
+    const bool perVertex = kUsePerVertex->isChecked();
+
+    for ( auto material : m_blinnphongmaterials )
     {
-        m_blinnphongmaterial->m_ns = Scalar( v );
-        updateEngine();
+        if ( m_pendingChanges & CHANGED_KD ) { material->m_kd = kd; }
+        if ( m_pendingChanges & CHANGED_KS ) { material->m_ks = ks; }
+        if ( m_pendingChanges & CHANGED_NS ) { material->m_ns = ns; }
+        if ( m_pendingChanges & CHANGED_PER_VERTEX ) { material->m_perVertexColor = perVertex; }
+        material->needUpdate();
     }
+    m_pendingChanges = 0;
+    emit materialChanged();
+}
+
+void MaterialEditor::onExpChanged( double ) {
+    scheduleUpdate( CHANGED_NS );
 }
 
 void MaterialEditor::onKdColorChanged( int ) {
     kdColorWidget->colorChanged( kdR->value(), kdG->value(), kdB->value() );
-
-    if ( m_renderObject && m_usable )
-    {
-        m_blinnphongmaterial->m_kd = Core::Utils::Color(
-            kdR->value() / 255_ra, kdG->value() / 255_ra, kdB->value() / 255_ra, 1_ra );
-        updateEngine();
-    }
+    scheduleUpdate( CHANGED_KD );
 }
 
 void MaterialEditor::onKsColorChanged( int ) {
     ksColorWidget->colorChanged( ksR->value(), ksG->value(), ksB->value() );
-
-    if ( m_renderObject && m_usable )
-    {
-        m_blinnphongmaterial->m_ks = Core::Utils::Color(
-            ksR->value() / 255_ra, ksG->value() / 255_ra, ksB->value() / 255_ra, 1_ra );
-        updateEngine();
-    }
+    scheduleUpdate( CHANGED_KS );
 }
 
 void MaterialEditor::newKdColor( const QColor& color ) {
@@ -99,12 +112,7 @@ void MaterialEditor::newKdColor( const QColor& color ) {
     kdG->setValue( color.green() );
     kdB->setValue( color.blue() );
 
-    if ( m_renderObject && m_usable )
-    {
-        m_blinnphongmaterial->m_kd =
-            Core::Utils::Color( color.redF(), color.greenF(), color.blueF(), 1. );
-        updateEngine();
-    }
+    scheduleUpdate( CHANGED_KD );
 }
 
 void MaterialEditor::newKsColor( const QColor& color ) {
@@ -116,12 +124,7 @@ void MaterialEditor::newKsColor( const QColor& color ) {
     ksG->setValue( color.green() );
     ksB->setValue( color.blue() );
 
-    if ( m_renderObject && m_usable )
-    {
-        m_blinnphongmaterial->m_ks =
-            Core::Utils::Color( color.redF(), color.greenF(), color.blueF(), 1. );
-        updateEngine();
-    }
+    scheduleUpdate( CHANGED_KS );
 }
 
 void MaterialEditor::showEvent( QShowEvent* e ) {
@@ -137,29 +140,53 @@ void MaterialEditor::closeEvent( QCloseEvent* /*e*/ ) {
 }
 
 void MaterialEditor::changeRenderObject( Core::Utils::Index roIdx ) {
-    if ( roIdx.isValid() )
+    changeRenderObjects( {roIdx} );
+}
+
+void MaterialEditor::changeRenderObjects( const std::vector<Core::Utils::Index>& roIndices ) {
+    // Modifications made to the previous render objects are not lost.
+    updateEngine();
+
+    auto roMgr = Engine::RadiumEngine::getInstance()->getRenderObjectManager();
+    std::vector<std::shared_ptr<Engine::Rendering::RenderObject>> renderObjects;
+    for ( const auto& roIdx : roIndices )
+    {
+        if ( !roIdx.isValid() ) { continue; }
+        auto ro = roMgr->getRenderObject( roIdx );
+        if ( ro != nullptr ) { renderObjects.push_back( ro ); }
+    }
+    if ( renderObjects.empty() ) { return; }
+
+    // Render objects may share their material, each material is updated once.
+    std::set<Ra::Engine::Data::BlinnPhongMaterial*> uniqueMaterials;
+    m_blinnphongmaterials.clear();
+    for ( const auto& ro : renderObjects )
     {
-        m_renderObject =
-            Engine::RadiumEngine::getInstance()->getRenderObjectManager()->getRenderObject( roIdx );
-
-        if ( m_renderObject != nullptr )
-        {
-            m_BlinnPhongGroup->hide();
-
-            auto genericMaterial = m_renderObject->getMaterial();
-            if ( genericMaterial->getMaterialName() == "BlinnPhong" )
-            {
-                m_blinnphongmaterial = const_cast<Ra::Engine::Data::BlinnPhongMaterial*>(
-                    dynamic_cast<const Ra::Engine::Data::BlinnPhongMaterial*>( genericMaterial.get() ) );
-                updateBlinnPhongViz();
-                m_BlinnPhongGroup->show();
-            }
-
-            m_usable = true;
-            m_roIdx  = roIdx;
-            m_renderObjectName->setText( m_renderObject->getName().c_str() );
-        }
+        auto genericMaterial = ro->getMaterial();
+        if ( genericMaterial->getMaterialName() != "BlinnPhong" ) { continue; }
+        auto material = const_cast<Ra::Engine::Data::BlinnPhongMaterial*>(
+            dynamic_cast<const Ra::Engine::Data::BlinnPhongMaterial*>( genericMaterial.get() ) );
+        if ( material != nullptr && uniqueMaterials.insert( material ).second )
+        { m_blinnphongmaterials.push_back( material ); }
     }
+
+    m_renderObjects = std::move( renderObjects );
+    m_renderObject  = m_renderObjects.front();
+
+    m_BlinnPhongGroup->hide();
+    if ( !m_blinnphongmaterials.empty() )
+    {
+        m_blinnphongmaterial = m_blinnphongmaterials.front();
+        updateBlinnPhongViz();
+        m_BlinnPhongGroup->show();
+    }
+
+    m_usable = true;
+    m_roIdx  = m_renderObject->getIndex();
+    QString name( m_renderObject->getName().c_str() );
+    if ( m_renderObjects.size() > 1 )
+    { name += QString( " (+%1 objects)" ).arg( m_renderObjects.size() - 1 ); }
+    m_renderObjectName->setText( name );
 }
 
 void MaterialEditor::updateBlinnPhongViz() {
@@ -202,10 +229,6 @@ void Ra::Gui::MaterialEditor::on_m_closeButton_clicked() {
     hide();
 }
 
-void Ra::Gui::MaterialEditor::on_kUsePerVertex_clicked( bool checked ) {
-    if ( m_renderObject && m_usable )
-    {
-        m_blinnphongmaterial->m_perVertexColor = checked;
-        updateEngine();
-    }
+void Ra::Gui::MaterialEditor::on_kUsePerVertex_clicked( bool ) {
+    scheduleUpdate( CHANGED_PER_VERTEX );
 }
@@ -4,6 +4,7 @@
 #include <QWidget>
 
 #include <memory>
+#include <vector>
 
 #include <Core/Utils/Index.hpp>
 
@@ -37,6 +38,10 @@ class MaterialEditor : public QWidget, private Ui::MaterialEditor
 
     void changeRenderObject( Ra::Core::Utils::Index roIdx );
 
+    /// Edit several render objects at once. The editor displays the material of the first one,
+    /// and each modification is applied to the BlinnPhong materials of all of them.
+    void changeRenderObjects( const std::vector<Ra::Core::Utils::Index>& roIndices );
+
   signals:
     void materialChanged();
 
@@ -58,8 +63,14 @@ class MaterialEditor : public QWidget, private Ui::MaterialEditor
   protected:
     virtual void showEvent( QShowEvent* e ) override;
     virtual void closeEvent( QCloseEvent* e ) override;
+
+    /// Apply the pending modifications to the edited materials and request a single redraw.
     void updateEngine();
 
+    /// Record modified parameters. They are applied once the current events are processed, so
+    /// that a burst of edits results in one material update per frame.
+    void scheduleUpdate( uint changes );
+
   private:
     bool m_visible;
 
@@ -70,6 +81,13 @@ class MaterialEditor : public QWidget, private Ui::MaterialEditor
     bool m_usable;
     Ra::Engine::Data::BlinnPhongMaterial* m_blinnphongmaterial;
 
+    /// Edited render objects, and their distinct BlinnPhong materials.
+    std::vector<std::shared_ptr<Engine::Rendering::RenderObject>> m_renderObjects;
+    std::vector<Ra::Engine::Data::BlinnPhongMaterial*> m_blinnphongmaterials;
+
+    /// Parameters modified since the last update, combination of ChangedParameter.
+    uint m_pendingChanges{0};
+
   private:
     enum {
         OUTPUT_FINAL    = 0,
@@ -77,6 +95,13 @@ class MaterialEditor : public QWidget, private Ui::MaterialEditor
         OUTPUT_SPECULAR = 2,
         OUTPUT_NORMAL   = 3,
     };
+
+    enum ChangedParameter : uint {
+        CHANGED_KD         = 1 << 0,
+        CHANGED_KS         = 1 << 1,
+        CHANGED_NS         = 1 << 2,
+        CHANGED_PER_VERTEX = 1 << 3,
+    };
 };
 } // namespace Gui
 } // namespace Ra
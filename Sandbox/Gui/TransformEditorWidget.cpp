@@ -8,27 +8,76 @@ namespace Gui {
 TransformEditorWidget::TransformEditorWidget( QWidget* parent ) :
     QWidget( parent ),
     m_layout( new QVBoxLayout( this ) ),
-    m_translationEditor( nullptr ) {}
+    m_translationEditor( nullptr ),
+    m_rotationEditor( nullptr ),
+    m_scaleEditor( nullptr ),
+    m_displayedTransform( Core::Transform::Identity() ),
+    m_displayValid( false ),
+    m_rotation( Core::Quaternion::Identity() ),
+    m_scale( Core::Vector3::Ones() ) {}
 
 void TransformEditorWidget::updateValues() {
     if ( canEdit() )
     {
         getTransform();
+        // Most frames do not move the edited object, do not touch the widgets then.
+        if ( m_displayValid && m_transform.matrix() == m_displayedTransform.matrix() ) { return; }
+        m_displayedTransform = m_transform;
+        m_displayValid       = true;
+
+        Core::Matrix3 rotation;
+        Core::Matrix3 scaling;
+        m_transform.computeRotationScaling( &rotation, &scaling );
+        m_rotation = Core::Quaternion( rotation );
+        m_scale    = scaling.diagonal();
+
         CORE_ASSERT( m_translationEditor, "No edtitor widget !" );
         m_translationEditor->blockSignals( true );
         m_translationEditor->setValue( m_transform.translation() );
         m_translationEditor->blockSignals( false );
+        m_rotationEditor->blockSignals( true );
+        m_rotationEditor->setValue( m_rotation );
+        m_rotationEditor->blockSignals( false );
+        m_scaleEditor->blockSignals( true );
+        m_scaleEditor->setValue( m_scale );
+        m_scaleEditor->blockSignals( false );
     }
 }
 
 void TransformEditorWidget::onChangedPosition( const Core::Vector3& v, uint id ) {
     CORE_ASSERT( m_currentEdit.isValid(), "Nothing to edit" );
-    m_transform.translation() = v;
+    applyTransform( v, m_rotation, m_scale );
+}
+
+void TransformEditorWidget::onChangedRotation( const Core::Quaternion& q, uint id ) {
+    CORE_ASSERT( m_currentEdit.isValid(), "Nothing to edit" );
+    applyTransform( m_transform.translation(), q, m_scale );
+}
+
+void TransformEditorWidget::onChangedScale( const Core::Vector3& s, uint id ) {
+    CORE_ASSERT( m_currentEdit.isValid(), "Nothing to edit" );
+    applyTransform( m_transform.translation(), m_rotation, s );
+}
+
+void TransformEditorWidget::applyTransform( const Core::Vector3& translation,
+                                            const Core::Quaternion& rotation,
+                                            const Core::Vector3& scale ) {
+    m_rotation = rotation;
+    m_scale    = scale;
+    m_transform.fromPositionOrientationScale( translation, rotation, scale );
     setTransform( m_transform );
+    // The widgets already display the new value.
+    m_displayedTransform = m_transform;
 }
 
 void TransformEditorWidget::setEditable( const Engine::Scene::ItemEntry& ent ) {
     delete m_translationEditor;
+    delete m_rotationEditor;
+    delete m_scaleEditor;
+    m_translationEditor = nullptr;
+    m_rotationEditor    = nullptr;
+    m_scaleEditor       = nullptr;
+    m_displayValid      = false;
     TransformEditor::setEditable( ent );
     if ( canEdit() )
     {
@@ -36,11 +85,24 @@ void TransformEditorWidget::setEditable( const Engine::Scene::ItemEntry& ent ) {
             new VectorEditor( 0,
                               QString::fromStdString( getEntryName(
                                   Engine::RadiumEngine::getInstance(), m_currentEdit ) ),
-                              true );
+                              true,
+                              this );
+        m_rotationEditor = new RotationEditor( 1, "Rotation", true, this );
+        m_scaleEditor    = new VectorEditor( 2, "Scale", true, this );
+        m_layout->addWidget( m_translationEditor );
+        m_layout->addWidget( m_rotationEditor );
+        m_layout->addWidget( m_scaleEditor );
         connect( m_translationEditor,
                  &VectorEditor::valueChanged,
                  this,
                  &TransformEditorWidget::onChangedPosition );
+        connect( m_rotationEditor,
+                 &RotationEditor::valueChanged,
+                 this,
+                 &TransformEditorWidget::onChangedRotation );
+        connect(
+            m_scaleEditor, &VectorEditor::valueChanged, this, &TransformEditorWidget::onChangedScale );
+        updateValues();
     }
 }
 } // namespace Gui
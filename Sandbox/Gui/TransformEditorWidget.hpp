@@ -3,6 +3,7 @@
 #include <QWidget>
 
 #include <Core/Containers/AlignedAllocator.hpp>
+#include <Gui/RotationEditor.hpp>
 #include <Gui/VectorEditor.hpp>
 #include <Gui/TransformEditor/TransformEditor.hpp>
 
@@ -26,19 +27,36 @@ class TransformEditorWidget : public QWidget, public Gui::TransformEditor
 
     /// Update the displays from the current state of the editable properties.
     /// This should be called at every frame if the watched object has been updated.
+    /// Widgets are only updated when the transform changed since the last call.
     void updateValues() override;
 
   private slots:
     // Called internally by the child widgets when their value change.
     void onChangedPosition( const Core::Vector3& v, uint id );
-    // void onChangedRotation( const Core::Quaternion& q, uint id );
+    void onChangedRotation( const Core::Quaternion& q, uint id );
+    void onChangedScale( const Core::Vector3& s, uint id );
 
   private:
+    /// Set the transform from its components and remember it as displayed.
+    void applyTransform( const Core::Vector3& translation,
+                         const Core::Quaternion& rotation,
+                         const Core::Vector3& scale );
+
     /// Layout of the widgets
     QLayout* m_layout;
 
-    /// Edition widget
+    /// Edition widgets
     VectorEditor* m_translationEditor;
+    RotationEditor* m_rotationEditor;
+    VectorEditor* m_scaleEditor;
+
+    /// Transform currently displayed by the widgets.
+    Core::Transform m_displayedTransform;
+    /// False until the widgets display the transform of the edited object.
+    bool m_displayValid;
+    /// Components of the displayed transform.
+    Core::Quaternion m_rotation;
+    Core::Vector3 m_scale;
 };
 } // namespace Gui
 } // namespace Ra
@@ -0,0 +1,285 @@
+#include <MeshArena.hpp>
+
+#include <Core/Utils/Log.hpp>
+#include <Engine/Data/ShaderProgram.hpp>
+
+#include <QOpenGLContext>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include <globjects/Program.h>
+#include <glbinding/gl/gl.h>
+
+namespace Ra {
+
+using namespace Core::Utils; // log
+using namespace gl;
+
+namespace {
+size_t align( size_t size ) {
+    return ( size + MeshArena::s_alignment - 1 ) / MeshArena::s_alignment * MeshArena::s_alignment;
+}
+} // namespace
+
+MeshArena::~MeshArena() {
+    // Buffers are released with the context when it is no longer current.
+    if ( QOpenGLContext::currentContext() == nullptr ) { return; }
+    for ( auto& fenced : m_fenced )
+    {
+        glDeleteSync( static_cast<GLsync>( fenced.first ) );
+    }
+    for ( auto& blocks : m_blocks )
+    {
+        for ( auto& block : blocks )
+        {
+            glDeleteBuffers( 1, &block.buffer );
+        }
+    }
+}
+
+MeshArena::Range MeshArena::allocate( BufferType type, size_t size ) {
+    Range range;
+    range.type = type;
+    range.size = align( std::max( size, size_t( 1 ) ) );
+
+    auto findRange = [this, &range]() {
+        auto& blocks = m_blocks[range.type];
+        for ( size_t b = 0; b < blocks.size(); ++b )
+        {
+            auto& freeRanges = blocks[b].freeRanges;
+            for ( auto it = freeRanges.begin(); it != freeRanges.end(); ++it )
+            {
+                if ( it->second < range.size ) { continue; }
+                range.block  = b;
+                range.offset = it->first;
+                // The rest of the free range stays free.
+                if ( it->second > range.size )
+                { freeRanges.emplace( it->first + range.size, it->second - range.size ); }
+                freeRanges.erase( it );
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Ranges released by complete frames are reused before growing the arena.
+    if ( !findRange() )
+    {
+        collect();
+        if ( !findRange() )
+        {
+            addBlock( type, range.size );
+            findRange();
+        }
+    }
+    m_allocatedSize += range.size;
+    return range;
+}
+
+void MeshArena::release( const Range& range ) {
+    if ( range.size == 0 ) { return; }
+    m_allocatedSize -= range.size;
+    m_released.push_back( range );
+}
+
+void MeshArena::write( const Range& range, size_t offset, const void* data, size_t size ) {
+    const Block& block = m_blocks[range.type][range.block];
+    if ( block.mapped != nullptr )
+    { std::memcpy( static_cast<char*>( block.mapped ) + range.offset + offset, data, size ); }
+    else
+    {
+        glBindBuffer( GL_COPY_WRITE_BUFFER, block.buffer );
+        glBufferSubData(
+            GL_COPY_WRITE_BUFFER, GLintptr( range.offset + offset ), GLsizeiptr( size ), data );
+        glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+    }
+}
+
+void MeshArena::collect() {
+    // Fences are signaled in order : stop at the first frame still in flight.
+    size_t complete = 0;
+    for ( ; complete < m_fenced.size(); ++complete )
+    {
+        const auto sync = static_cast<GLsync>( m_fenced[complete].first );
+        if ( glClientWaitSync( sync, SyncObjectMask::GL_NONE_BIT, GLuint64( 0 ) ) ==
+             GL_TIMEOUT_EXPIRED )
+        { break; }
+        glDeleteSync( sync );
+        for ( const auto& range : m_fenced[complete].second )
+        {
+            freeRange( range );
+        }
+    }
+    m_fenced.erase( m_fenced.begin(), m_fenced.begin() + std::ptrdiff_t( complete ) );
+
+    if ( !m_released.empty() )
+    {
+        void* fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, UnusedMask::GL_UNUSED_BIT );
+        m_fenced.emplace_back( fence, std::move( m_released ) );
+        m_released.clear();
+    }
+}
+
+uint MeshArena::getBuffer( const Range& range ) const {
+    return m_blocks[range.type][range.block].buffer;
+}
+
+size_t MeshArena::getNumBlocks() const {
+    size_t count = 0;
+    for ( const auto& blocks : m_blocks )
+    {
+        count += blocks.size();
+    }
+    return count;
+}
+
+size_t MeshArena::addBlock( BufferType type, size_t size ) {
+    if ( !m_checkedStorage )
+    {
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv( GL_MAJOR_VERSION, &major );
+        glGetIntegerv( GL_MINOR_VERSION, &minor );
+        m_persistent     = major > 4 || ( major == 4 && minor >= 4 );
+        m_checkedStorage = true;
+        if ( !m_persistent )
+        { LOG( logINFO ) << "Mesh arena : no buffer storage, ranges are written with copies."; }
+    }
+
+    Block block;
+    block.size = std::max( size, s_blockSize );
+    glGenBuffers( 1, &block.buffer );
+    glBindBuffer( GL_COPY_WRITE_BUFFER, block.buffer );
+    if ( m_persistent )
+    {
+        glBufferStorage( GL_COPY_WRITE_BUFFER,
+                         GLsizeiptr( block.size ),
+                         nullptr,
+                         BufferStorageMask::GL_MAP_WRITE_BIT |
+                             BufferStorageMask::GL_MAP_PERSISTENT_BIT |
+                             BufferStorageMask::GL_MAP_COHERENT_BIT );
+        block.mapped = glMapBufferRange( GL_COPY_WRITE_BUFFER,
+                                         0,
+                                         GLsizeiptr( block.size ),
+                                         MapBufferAccessMask::GL_MAP_WRITE_BIT |
+                                             MapBufferAccessMask::GL_MAP_PERSISTENT_BIT |
+                                             MapBufferAccessMask::GL_MAP_COHERENT_BIT );
+    }
+    else
+    { glBufferData( GL_COPY_WRITE_BUFFER, GLsizeiptr( block.size ), nullptr, GL_STATIC_DRAW ); }
+    glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+    block.freeRanges.emplace( 0, block.size );
+
+    auto& blocks = m_blocks[type];
+    blocks.push_back( std::move( block ) );
+    LOG( logINFO ) << "Mesh arena : " << ( type == VERTEX_BUFFER ? "vertex" : "index" )
+                   << " block of " << ( blocks.back().size >> 20 ) << " MB added.";
+    return blocks.size() - 1;
+}
+
+void MeshArena::freeRange( const Range& range ) {
+    auto& freeRanges = m_blocks[range.type][range.block].freeRanges;
+    auto it          = freeRanges.emplace( range.offset, range.size ).first;
+    // Merge with the next free range, then with the previous one.
+    auto next = std::next( it );
+    if ( next != freeRanges.end() && it->first + it->second == next->first )
+    {
+        it->second += next->second;
+        freeRanges.erase( next );
+    }
+    if ( it != freeRanges.begin() )
+    {
+        auto previous = std::prev( it );
+        if ( previous->first + previous->second == it->first )
+        {
+            previous->second += it->second;
+            freeRanges.erase( it );
+        }
+    }
+}
+
+ArenaMesh::ArenaMesh( const std::string& name,
+                      Core::Geometry::TriangleMesh&& mesh,
+                      std::shared_ptr<MeshArena> arena ) :
+    Engine::Data::Mesh( name ),
+    m_arena( std::move( arena ) ) {
+    loadGeometry( std::move( mesh ) );
+}
+
+ArenaMesh::~ArenaMesh() {
+    m_arena->release( m_vertices );
+    m_arena->release( m_indices );
+    if ( m_vertexArray != 0 && QOpenGLContext::currentContext() != nullptr )
+    { glDeleteVertexArrays( 1, &m_vertexArray ); }
+}
+
+void ArenaMesh::updateGL() {
+    m_arena->collect();
+    if ( m_uploaded ) { return; }
+
+    // Attributes are stored one after the other, each one aligned.
+    const auto& mesh = getCoreGeometry();
+    size_t size      = 0;
+    mesh.vertexAttribs().for_each_attrib( [this, &size]( Core::Utils::AttribBase* attrib ) {
+        m_attribs.push_back( {attrib->getName(), size, uint( attrib->getNumberOfComponents() )} );
+        size += align( attrib->getBufferSize() );
+    } );
+    m_vertices = m_arena->allocate( MeshArena::VERTEX_BUFFER, size );
+    size_t i   = 0;
+    mesh.vertexAttribs().for_each_attrib( [this, &i]( Core::Utils::AttribBase* attrib ) {
+        m_arena->write(
+            m_vertices, m_attribs[i++].offset, attrib->dataPtr(), attrib->getBufferSize() );
+    } );
+
+    const auto& indices = mesh.getIndices();
+    const size_t indexSize = indices.size() * sizeof( indices[0] );
+    m_numIndices           = indices.size() * 3;
+    m_indices              = m_arena->allocate( MeshArena::INDEX_BUFFER, indexSize );
+    m_arena->write( m_indices, 0, indices.data(), indexSize );
+
+    glGenVertexArrays( 1, &m_vertexArray );
+    glBindVertexArray( m_vertexArray );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_arena->getBuffer( m_indices ) );
+    glBindVertexArray( 0 );
+    m_uploaded = true;
+}
+
+void ArenaMesh::render( const Engine::Data::ShaderProgram* prog ) {
+    if ( m_vertexArray == 0 || prog == nullptr ) { return; }
+    glBindVertexArray( m_vertexArray );
+
+    // The renderer draws the mesh with the programs of its different passes, and reloading the
+    // shaders replaces them : the attributes are bound to each program drawing the mesh.
+    const GLuint program = prog->getProgramObject()->id();
+    for ( const auto& location : m_enabledLocations )
+    {
+        glDisableVertexAttribArray( GLuint( location ) );
+    }
+    m_enabledLocations.clear();
+    const GLenum scalarType = sizeof( Scalar ) == sizeof( float ) ? GL_FLOAT : GL_DOUBLE;
+    glBindBuffer( GL_ARRAY_BUFFER, m_arena->getBuffer( m_vertices ) );
+    for ( const auto& attrib : m_attribs )
+    {
+        const GLint location = glGetAttribLocation( program, attrib.name.c_str() );
+        if ( location < 0 ) { continue; }
+        glVertexAttribPointer( GLuint( location ),
+                               GLint( attrib.components ),
+                               scalarType,
+                               GL_FALSE,
+                               0,
+                               reinterpret_cast<void*>( m_vertices.offset + attrib.offset ) );
+        glEnableVertexAttribArray( GLuint( location ) );
+        m_enabledLocations.push_back( location );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    glDrawElements( GL_TRIANGLES,
+                    GLsizei( m_numIndices ),
+                    GL_UNSIGNED_INT,
+                    reinterpret_cast<void*>( m_indices.offset ) );
+    glBindVertexArray( 0 );
+}
+
+} // namespace Ra
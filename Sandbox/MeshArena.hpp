@@ -0,0 +1,129 @@
+#ifndef RADIUMENGINE_MESHARENA_HPP
+#define RADIUMENGINE_MESHARENA_HPP
+
+#include <Core/Geometry/TriangleMesh.hpp>
+#include <Engine/Data/Mesh.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Ra {
+
+/// Large vertex and index buffers shared by many meshes, each mesh taking ranges of them.
+///
+/// Buffers are allocated by blocks of s_blockSize bytes (or more for a larger range) and
+/// sub-allocated with a first fit free list, adjacent free ranges being merged. When the context
+/// supports buffer storage (OpenGL 4.4), blocks are persistently and coherently mapped, so that
+/// uploading a mesh is a memcpy into the mapped memory. Otherwise ranges are written with
+/// glBufferSubData.
+/// Released ranges may still be read by the frames in flight : they are fenced and only reused
+/// once the GPU is done with them.
+/// All the methods must be called with the OpenGL context current.
+class MeshArena
+{
+  public:
+    enum BufferType { VERTEX_BUFFER = 0, INDEX_BUFFER, NUM_BUFFER_TYPES };
+
+    /// Range of a block, size 0 when invalid.
+    struct Range {
+        BufferType type{VERTEX_BUFFER};
+        size_t block{0};
+        size_t offset{0};
+        size_t size{0};
+    };
+
+    MeshArena() = default;
+    MeshArena( const MeshArena& ) = delete;
+    MeshArena& operator=( const MeshArena& ) = delete;
+    ~MeshArena();
+
+    /// Take a range of at least size bytes, aligned on s_alignment.
+    Range allocate( BufferType type, size_t size );
+    /// Give a range back, it is reused once the frames using it are rendered.
+    void release( const Range& range );
+    /// Copy data at offset bytes in a range.
+    void write( const Range& range, size_t offset, const void* data, size_t size );
+    /// Make the released ranges whose frames are complete available again, and fence the ones
+    /// released since the last call.
+    void collect();
+
+    /// Buffer object holding a range.
+    uint getBuffer( const Range& range ) const;
+
+    /// Number of buffer objects created, and of bytes used by the ranges.
+    size_t getNumBlocks() const;
+    size_t getAllocatedSize() const { return m_allocatedSize; }
+
+    /// Ranges are aligned for any vertex attribute and index type.
+    static constexpr size_t s_alignment{16};
+    /// Minimum size of the buffer objects, in bytes.
+    static constexpr size_t s_blockSize{32 << 20};
+
+  private:
+    struct Block {
+        uint buffer{0};
+        /// Persistently mapped memory, null when the block is written with glBufferSubData.
+        void* mapped{nullptr};
+        size_t size{0};
+        /// Free ranges, size by offset.
+        std::map<size_t, size_t> freeRanges;
+    };
+
+    /// Add a block of at least size bytes.
+    size_t addBlock( BufferType type, size_t size );
+    /// Return a range to the free list of its block, merging it with its neighbours.
+    void freeRange( const Range& range );
+
+    std::vector<Block> m_blocks[NUM_BUFFER_TYPES];
+    /// Ranges released since the last collect().
+    std::vector<Range> m_released;
+    /// Released ranges, with the fence of the last frame that may use them.
+    std::vector<std::pair<void*, std::vector<Range>>> m_fenced;
+    size_t m_allocatedSize{0};
+    /// Buffer storage support, checked when the first block is created.
+    bool m_checkedStorage{false};
+    bool m_persistent{false};
+};
+
+/// Triangle mesh whose vertex attributes and indices are stored in the ranges of a MeshArena,
+/// instead of buffers of its own.
+///
+/// The attributes of the core mesh are stored one after the other in a vertex range and bound by
+/// name to the attributes of the program drawing the mesh. The GPU data is written once : later
+/// modifications of the core mesh are not uploaded.
+class ArenaMesh : public Engine::Data::Mesh
+{
+  public:
+    ArenaMesh( const std::string& name,
+               Core::Geometry::TriangleMesh&& mesh,
+               std::shared_ptr<MeshArena> arena );
+    ~ArenaMesh() override;
+
+    void updateGL() override;
+    void render( const Engine::Data::ShaderProgram* prog ) override;
+
+  private:
+    struct Attrib {
+        std::string name;
+        size_t offset;
+        uint components;
+    };
+
+    std::shared_ptr<MeshArena> m_arena;
+    MeshArena::Range m_vertices;
+    MeshArena::Range m_indices;
+    std::vector<Attrib> m_attribs;
+    size_t m_numIndices{0};
+    bool m_uploaded{false};
+
+    /// Only records the element buffer, attributes are bound for each program.
+    uint m_vertexArray{0};
+    std::vector<int> m_enabledLocations;
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_MESHARENA_HPP
@@ -0,0 +1,212 @@
+#include <MeshMerger.hpp>
+
+#include <Core/Asset/BlinnPhongMaterialData.hpp>
+#include <Core/Utils/Log.hpp>
+#include <Engine/Data/BlinnPhongMaterial.hpp>
+#include <Engine/Data/Mesh.hpp>
+#include <Engine/RadiumEngine.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+#include <Engine/Rendering/RenderObjectManager.hpp>
+#include <Engine/Scene/Entity.hpp>
+#include <Engine/Scene/EntityManager.hpp>
+#include <Engine/Scene/GeometryComponent.hpp>
+#include <Engine/Scene/System.hpp>
+
+#include <array>
+#include <map>
+
+namespace Ra {
+
+using namespace Core::Utils; // log
+
+namespace {
+using RenderObjectPtr = std::shared_ptr<Engine::Rendering::RenderObject>;
+using BlinnPhong      = Engine::Data::BlinnPhongMaterial;
+
+/// Material parameters of a BlinnPhong material : kd, ks, ns and per vertex color.
+using MaterialKey = std::array<Scalar, 10>;
+
+/// Name of the per vertex color attribute of the meshes.
+constexpr const char* s_colorAttribName{"in_color"};
+
+BlinnPhong* getMergeableMaterial( const Engine::Rendering::RenderObject& ro ) {
+    if ( ro.getType() != Engine::Rendering::RenderObjectType::Geometry || ro.isTransparent() )
+    { return nullptr; }
+
+    auto genericMaterial = ro.getMaterial();
+    if ( genericMaterial == nullptr || genericMaterial->getMaterialName() != "BlinnPhong" )
+    { return nullptr; }
+    auto material =
+        const_cast<BlinnPhong*>( dynamic_cast<const BlinnPhong*>( genericMaterial.get() ) );
+    if ( material == nullptr ) { return nullptr; }
+
+    for ( auto semantic : {BlinnPhong::TextureSemantic::TEX_DIFFUSE,
+                           BlinnPhong::TextureSemantic::TEX_SPECULAR,
+                           BlinnPhong::TextureSemantic::TEX_NORMAL,
+                           BlinnPhong::TextureSemantic::TEX_SHININESS,
+                           BlinnPhong::TextureSemantic::TEX_ALPHA} )
+    {
+        if ( material->getTexture( semantic ) != nullptr ) { return nullptr; }
+    }
+    return material;
+}
+
+MaterialKey getMaterialKey( const BlinnPhong& material ) {
+    return {material.m_kd( 0 ),
+            material.m_kd( 1 ),
+            material.m_kd( 2 ),
+            material.m_kd( 3 ),
+            material.m_ks( 0 ),
+            material.m_ks( 1 ),
+            material.m_ks( 2 ),
+            material.m_ks( 3 ),
+            material.m_ns,
+            material.m_perVertexColor ? 1_ra : 0_ra};
+}
+
+const Core::Geometry::TriangleMesh* getMergeableGeometry( const Engine::Rendering::RenderObject& ro,
+                                                           bool perVertexColor ) {
+    auto mesh = std::dynamic_pointer_cast<Engine::Data::Mesh>( ro.getMesh() );
+    if ( mesh == nullptr ) { return nullptr; }
+
+    const auto& geometry = mesh->getCoreGeometry();
+    if ( geometry.vertices().empty() || geometry.normals().size() != geometry.vertices().size() )
+    { return nullptr; }
+    if ( perVertexColor )
+    {
+        auto handle = geometry.getAttribHandle<Core::Vector4>( s_colorAttribName );
+        if ( !geometry.isValid( handle ) ||
+             geometry.getAttrib( handle ).data().size() != geometry.vertices().size() )
+        { return nullptr; }
+    }
+    return &geometry;
+}
+
+/// Merge the geometry of render objects, in world space.
+Core::Geometry::TriangleMesh mergeGeometry( const std::vector<RenderObjectPtr>& ros,
+                                            bool perVertexColor ) {
+    Core::Vector3Array vertices;
+    Core::Vector3Array normals;
+    Core::Vector4Array colors;
+    Core::Geometry::TriangleMesh::IndexContainerType indices;
+
+    for ( const auto& ro : ros )
+    {
+        const auto& geometry             = *getMergeableGeometry( *ro, perVertexColor );
+        const Core::Transform transform  = ro->getTransform();
+        const Core::Matrix3 normalMatrix = transform.linear().inverse().transpose();
+        const uint offset                = uint( vertices.size() );
+
+        for ( const auto& v : geometry.vertices() )
+        {
+            vertices.push_back( transform * v );
+        }
+        for ( const auto& n : geometry.normals() )
+        {
+            normals.push_back( ( normalMatrix * n ).normalized() );
+        }
+        if ( perVertexColor )
+        {
+            const auto& meshColors =
+                geometry.getAttrib( geometry.getAttribHandle<Core::Vector4>( s_colorAttribName ) )
+                    .data();
+            colors.insert( colors.end(), meshColors.begin(), meshColors.end() );
+        }
+        for ( const auto& t : geometry.getIndices() )
+        {
+            indices.emplace_back( t + Core::Vector3ui::Constant( offset ) );
+        }
+    }
+
+    Core::Geometry::TriangleMesh merged;
+    merged.setVertices( std::move( vertices ) );
+    merged.setNormals( std::move( normals ) );
+    merged.setIndices( std::move( indices ) );
+    if ( perVertexColor ) { merged.addAttrib<Core::Vector4>( s_colorAttribName, colors ); }
+    return merged;
+}
+} // namespace
+
+Engine::Scene::Entity* MeshMerger::mergeByMaterial( const std::vector<RenderObjectPtr>& ros,
+                                                    const std::string& entityName,
+                                                    std::vector<RenderObjectPtr>& merged ) {
+    // Group the render objects by material parameters, the first material of each group is
+    // used as a model for the merged one.
+    std::map<MaterialKey, std::pair<BlinnPhong*, std::vector<RenderObjectPtr>>> groups;
+    for ( const auto& ro : ros )
+    {
+        auto material = getMergeableMaterial( *ro );
+        if ( material == nullptr ||
+             getMergeableGeometry( *ro, material->m_perVertexColor ) == nullptr )
+        { continue; }
+        auto& group = groups[getMaterialKey( *material )];
+        if ( group.first == nullptr ) { group.first = material; }
+        group.second.push_back( ro );
+    }
+
+    // Split the groups in chunks of at most s_maxMergedVertices vertices. Chunks of a single
+    // render object would not save anything.
+    std::vector<std::pair<BlinnPhong*, std::vector<RenderObjectPtr>>> chunks;
+    for ( auto& group : groups )
+    {
+        BlinnPhong* model = group.second.first;
+        std::vector<RenderObjectPtr> chunk;
+        size_t chunkVertices = 0;
+        for ( const auto& ro : group.second.second )
+        {
+            const size_t numVertices =
+                getMergeableGeometry( *ro, model->m_perVertexColor )->vertices().size();
+            if ( !chunk.empty() && chunkVertices + numVertices > s_maxMergedVertices )
+            {
+                if ( chunk.size() > 1 ) { chunks.emplace_back( model, chunk ); }
+                chunk.clear();
+                chunkVertices = 0;
+            }
+            chunk.push_back( ro );
+            chunkVertices += numVertices;
+        }
+        if ( chunk.size() > 1 ) { chunks.emplace_back( model, chunk ); }
+    }
+    if ( chunks.empty() ) { return nullptr; }
+
+    auto engine = Engine::RadiumEngine::getInstance();
+    auto system = engine->getSystem( "GeometrySystem" );
+    if ( system == nullptr )
+    {
+        LOG( logERROR ) << "No GeometrySystem, objects cannot be merged.";
+        return nullptr;
+    }
+    auto entity = engine->getEntityManager()->createEntity( entityName );
+    auto romgr  = engine->getRenderObjectManager();
+
+    for ( size_t i = 0; i < chunks.size(); ++i )
+    {
+        const BlinnPhong& model   = *chunks[i].first;
+        const auto& chunkObjects  = chunks[i].second;
+        const std::string name    = entityName + "_" + std::to_string( i );
+        const bool perVertexColor = model.m_perVertexColor;
+
+        Core::Asset::BlinnPhongMaterialData materialData( name );
+        auto component = new Engine::Scene::TriangleMeshComponent(
+            name, entity, mergeGeometry( chunkObjects, perVertexColor ), &materialData );
+        system->addComponent( entity, component );
+
+        // The material parameters are copied after the conversion, the converter only knows
+        // about the loaded material data.
+        auto ro       = romgr->getRenderObject( component->m_renderObjects[0] );
+        auto material = const_cast<BlinnPhong*>(
+            dynamic_cast<const BlinnPhong*>( ro->getMaterial().get() ) );
+        if ( material != nullptr )
+        {
+            material->m_kd             = model.m_kd;
+            material->m_ks             = model.m_ks;
+            material->m_ns             = model.m_ns;
+            material->m_perVertexColor = perVertexColor;
+            material->needUpdate();
+        }
+        merged.insert( merged.end(), chunkObjects.begin(), chunkObjects.end() );
+    }
+    return entity;
+}
+
+} // namespace Ra
@@ -0,0 +1,49 @@
+#ifndef RADIUMENGINE_MESHMERGER_HPP
+#define RADIUMENGINE_MESHMERGER_HPP
+
+#include <Core/Types.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Ra {
+namespace Engine {
+namespace Rendering {
+class RenderObject;
+} // namespace Rendering
+namespace Scene {
+class Entity;
+} // namespace Scene
+} // namespace Engine
+} // namespace Ra
+
+namespace Ra {
+
+/// Merges the render objects drawn with the same BlinnPhong parameters into larger meshes, so
+/// that scenes made of many small objects are drawn with fewer draw calls and state changes.
+///
+/// Vertices and normals are transformed to world space, the merged meshes belong to a new
+/// entity with an identity transform. Only opaque triangle meshes with normals and without
+/// textures are merged. The merged render objects themselves are not modified.
+///
+/// The merged meshes are a copy : there is no per object transform or material buffer, so
+/// editing, animating or picking the merged objects does not affect the merged meshes.
+class MeshMerger
+{
+  public:
+    /// Maximum number of vertices of a merged mesh, so that merged meshes can still be culled.
+    static constexpr size_t s_maxMergedVertices{1 << 20};
+
+    /// Merge the compatible render objects of the list in a new entity, the merged render
+    /// objects are appended to merged. Returns the new entity, or nullptr if nothing was merged.
+    /// The render techniques of the created render objects still have to be built.
+    static Engine::Scene::Entity*
+    mergeByMaterial( const std::vector<std::shared_ptr<Engine::Rendering::RenderObject>>& ros,
+                     const std::string& entityName,
+                     std::vector<std::shared_ptr<Engine::Rendering::RenderObject>>& merged );
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_MESHMERGER_HPP
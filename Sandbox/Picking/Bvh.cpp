@@ -0,0 +1,217 @@
+#include <Picking/Bvh.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <set>
+
+namespace Ra {
+namespace Picking {
+
+namespace {
+Scalar halfArea( const Core::Aabb& box ) {
+    if ( box.isEmpty() ) { return 0_ra; }
+    const Core::Vector3 s = box.sizes();
+    return s.x() * s.y() + s.y() * s.z() + s.z() * s.x();
+}
+} // namespace
+
+void Bvh::build( const std::vector<Core::Aabb>& boxes ) {
+    m_nodes.clear();
+    m_parents.clear();
+    m_leaves.clear();
+    m_primitives.resize( boxes.size() );
+    std::iota( m_primitives.begin(), m_primitives.end(), 0u );
+    if ( boxes.empty() ) { return; }
+
+    std::vector<Core::Vector3> centers( boxes.size() );
+    for ( size_t i = 0; i < boxes.size(); ++i )
+    {
+        centers[i] = boxes[i].center();
+    }
+
+    m_nodes.reserve( 2 * boxes.size() );
+    m_nodes.emplace_back();
+    buildNode( 0, 0, uint( boxes.size() ), 0, boxes, centers );
+    linkNodes();
+}
+
+void Bvh::linkNodes() {
+    m_parents.assign( m_nodes.size(), s_noParent );
+    m_leaves.assign( m_primitives.size(), 0 );
+    for ( uint n = 0; n < uint( m_nodes.size() ); ++n )
+    {
+        const Node& node = m_nodes[n];
+        if ( node.count > 0 )
+        {
+            for ( uint i = node.first; i < node.first + node.count; ++i )
+            {
+                m_leaves[m_primitives[i]] = n;
+            }
+        }
+        else
+        {
+            m_parents[n + 1]      = n;
+            m_parents[node.first] = n;
+        }
+    }
+}
+
+void Bvh::buildNode( uint node,
+                     uint begin,
+                     uint end,
+                     uint depth,
+                     const std::vector<Core::Aabb>& boxes,
+                     const std::vector<Core::Vector3>& centers ) {
+    Core::Aabb box;
+    Core::Aabb centerBox;
+    for ( uint i = begin; i < end; ++i )
+    {
+        box.extend( boxes[m_primitives[i]] );
+        centerBox.extend( centers[m_primitives[i]] );
+    }
+    m_nodes[node].box   = box;
+    m_nodes[node].first = begin;
+    m_nodes[node].count = end - begin;
+
+    const uint count = end - begin;
+    if ( count <= s_maxLeafSize || depth >= s_maxDepth ) { return; }
+
+    // Split along the axis of largest centroid extent.
+    int axis;
+    const Core::Vector3 extent = centerBox.sizes();
+    extent.maxCoeff( &axis );
+    if ( extent[axis] <= 0_ra ) { return; } // all centroids are the same
+
+    struct Bin {
+        Core::Aabb box;
+        uint count{0};
+    };
+    std::array<Bin, s_numBins> bins;
+    const Scalar scale = Scalar( s_numBins ) / extent[axis];
+    auto binOf         = [&]( uint p ) {
+        return std::min( s_numBins - 1,
+                         int( ( centers[p][axis] - centerBox.min()[axis] ) * scale ) );
+    };
+    for ( uint i = begin; i < end; ++i )
+    {
+        auto& bin = bins[binOf( m_primitives[i] )];
+        bin.box.extend( boxes[m_primitives[i]] );
+        ++bin.count;
+    }
+
+    // Surface area heuristic cost of splitting after each bin.
+    std::array<Scalar, s_numBins - 1> cost;
+    Core::Aabb acc;
+    uint accCount = 0;
+    for ( int b = 0; b < s_numBins - 1; ++b )
+    {
+        acc.extend( bins[b].box );
+        accCount += bins[b].count;
+        cost[b] = halfArea( acc ) * Scalar( accCount );
+    }
+    acc      = Core::Aabb();
+    accCount = 0;
+    for ( int b = s_numBins - 1; b > 0; --b )
+    {
+        acc.extend( bins[b].box );
+        accCount += bins[b].count;
+        cost[b - 1] += halfArea( acc ) * Scalar( accCount );
+    }
+    const int split = int( std::min_element( cost.begin(), cost.end() ) - cost.begin() );
+
+    uint* first = m_primitives.data() + begin;
+    uint* last  = m_primitives.data() + end;
+    uint mid    = uint( std::partition( first, last, [&]( uint p ) { return binOf( p ) <= split; } ) -
+                     m_primitives.data() );
+    if ( mid == begin || mid == end )
+    {
+        // Degenerate distribution, fall back to a median split.
+        mid = ( begin + end ) / 2;
+        std::nth_element( first, m_primitives.data() + mid, last, [&]( uint a, uint b ) {
+            return centers[a][axis] < centers[b][axis];
+        } );
+    }
+
+    // The first child directly follows its parent, the second one follows the first subtree.
+    m_nodes[node].count = 0;
+    const uint left     = uint( m_nodes.size() );
+    m_nodes.emplace_back();
+    buildNode( left, begin, mid, depth + 1, boxes, centers );
+    const uint right    = uint( m_nodes.size() );
+    m_nodes[node].first = right;
+    m_nodes.emplace_back();
+    buildNode( right, mid, end, depth + 1, boxes, centers );
+}
+
+void Bvh::refit( const std::vector<Core::Aabb>& boxes ) {
+    // Children are always stored after their parent.
+    for ( size_t n = m_nodes.size(); n-- > 0; )
+    {
+        refitNode( uint( n ), boxes );
+    }
+}
+
+void Bvh::refit( const std::vector<Core::Aabb>& boxes, const std::vector<uint>& changed ) {
+    // Processing the largest index first updates both children of a node before the node.
+    std::set<uint, std::greater<uint>> dirty;
+    for ( const auto p : changed )
+    {
+        dirty.insert( m_leaves[p] );
+    }
+    while ( !dirty.empty() )
+    {
+        const uint n = *dirty.begin();
+        dirty.erase( dirty.begin() );
+        refitNode( n, boxes );
+        if ( m_parents[n] != s_noParent ) { dirty.insert( m_parents[n] ); }
+    }
+}
+
+void Bvh::refitNode( uint n, const std::vector<Core::Aabb>& boxes ) {
+    Node& node = m_nodes[n];
+    node.box   = Core::Aabb();
+    if ( node.count > 0 )
+    {
+        for ( uint i = node.first; i < node.first + node.count; ++i )
+        {
+            node.box.extend( boxes[m_primitives[i]] );
+        }
+    }
+    else
+    {
+        node.box.extend( m_nodes[n + 1].box );
+        node.box.extend( m_nodes[node.first].box );
+    }
+}
+
+Scalar Bvh::hit( const Core::Aabb& box,
+                 const Core::Vector3& origin,
+                 const Core::Vector3& invDir,
+                 Scalar tMax ) {
+    if ( box.isEmpty() ) { return -1_ra; }
+    Scalar tNear = 0_ra;
+    Scalar tFar  = tMax;
+    for ( int i = 0; i < 3; ++i )
+    {
+        // A ray parallel to the slab only hits it from inside, the product below would give
+        // 0 * inf = NaN when the origin lies on a slab plane.
+        if ( std::isinf( invDir[i] ) )
+        {
+            if ( origin[i] < box.min()[i] || origin[i] > box.max()[i] ) { return -1_ra; }
+            continue;
+        }
+        Scalar t0 = ( box.min()[i] - origin[i] ) * invDir[i];
+        Scalar t1 = ( box.max()[i] - origin[i] ) * invDir[i];
+        if ( t0 > t1 ) { std::swap( t0, t1 ); }
+        tNear = std::max( tNear, t0 );
+        tFar  = std::min( tFar, t1 );
+        if ( tNear > tFar ) { return -1_ra; }
+    }
+    return tNear;
+}
+
+} // namespace Picking
+} // namespace Ra
@@ -0,0 +1,130 @@
+#ifndef RADIUMENGINE_PICKING_BVH_HPP
+#define RADIUMENGINE_PICKING_BVH_HPP
+
+#include <Core/Types.hpp>
+
+#include <vector>
+
+namespace Ra {
+namespace Picking {
+
+/// Bounding volume hierarchy over a set of boxes, built with a binned surface area heuristic.
+/// The primitives themselves are not stored : they are identified by their index in the box
+/// array given to build(), and tested by the functor given to intersect().
+class Bvh
+{
+  public:
+    /// Build the hierarchy, previous content is discarded.
+    void build( const std::vector<Core::Aabb>& boxes );
+
+    /// Update the node boxes after the primitives moved, without changing the tree topology.
+    /// \pre boxes has the same size as when the hierarchy was built.
+    void refit( const std::vector<Core::Aabb>& boxes );
+
+    /// Same as refit( boxes ), when only the listed primitives moved : only their leaves and the
+    /// ancestors of these leaves are updated.
+    void refit( const std::vector<Core::Aabb>& boxes, const std::vector<uint>& changed );
+
+    bool empty() const { return m_nodes.empty(); }
+
+    /// Number of primitives the hierarchy was built for.
+    size_t getNumPrimitives() const { return m_primitives.size(); }
+
+    /// Call intersectPrimitive( index, tMax ) for each primitive whose box is hit by the ray
+    /// between 0 and tMax. The functor returns true when it found a hit, after setting tMax to
+    /// the distance of this hit, which then discards farther nodes.
+    template <typename F>
+    bool intersect( const Core::Ray& ray, Scalar& tMax, F&& intersectPrimitive ) const;
+
+  private:
+    struct Node {
+        Core::Aabb box;
+        /// Leaf : index of the first primitive in m_primitives.
+        /// Inner node : index of the second child (the first one is the next node).
+        uint first{0};
+        /// Number of primitives, 0 for inner nodes.
+        uint count{0};
+    };
+
+    void buildNode( uint node,
+                    uint begin,
+                    uint end,
+                    uint depth,
+                    const std::vector<Core::Aabb>& boxes,
+                    const std::vector<Core::Vector3>& centers );
+
+    /// Fill m_parents and m_leaves once the tree is built.
+    void linkNodes();
+
+    /// Recompute the box of a node from its primitives or from its children.
+    void refitNode( uint n, const std::vector<Core::Aabb>& boxes );
+
+    /// Slab test, returns the entry distance or a negative value if the box is missed.
+    /// Infinite components of invDir correspond to rays parallel to a slab.
+    static Scalar hit( const Core::Aabb& box,
+                       const Core::Vector3& origin,
+                       const Core::Vector3& invDir,
+                       Scalar tMax );
+
+    static constexpr uint s_maxLeafSize{4};
+    static constexpr uint s_maxDepth{64};
+    static constexpr int s_numBins{12};
+
+    static constexpr uint s_noParent{~0u};
+
+    std::vector<Node> m_nodes;
+    std::vector<uint> m_primitives;
+    /// Parent of each node, s_noParent for the root.
+    std::vector<uint> m_parents;
+    /// Leaf containing each primitive.
+    std::vector<uint> m_leaves;
+};
+
+template <typename F>
+bool Bvh::intersect( const Core::Ray& ray, Scalar& tMax, F&& intersectPrimitive ) const {
+    if ( m_nodes.empty() ) { return false; }
+
+    const Core::Vector3 origin = ray.origin();
+    const Core::Vector3 invDir = ray.direction().cwiseInverse();
+
+    bool found = false;
+    uint stack[s_maxDepth + 2];
+    int top      = 0;
+    stack[top++] = 0;
+    while ( top > 0 )
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if ( hit( node.box, origin, invDir, tMax ) < 0 ) { continue; }
+
+        if ( node.count > 0 )
+        {
+            for ( uint i = node.first; i < node.first + node.count; ++i )
+            {
+                if ( intersectPrimitive( m_primitives[i], tMax ) ) { found = true; }
+            }
+        }
+        else
+        {
+            // Visit the closest child first so that tMax shrinks as early as possible.
+            const uint left  = uint( &node - m_nodes.data() ) + 1;
+            const uint right = node.first;
+            const Scalar tl  = hit( m_nodes[left].box, origin, invDir, tMax );
+            const Scalar tr  = hit( m_nodes[right].box, origin, invDir, tMax );
+            if ( tl >= 0 && tr >= 0 )
+            {
+                stack[top++] = tl < tr ? right : left;
+                stack[top++] = tl < tr ? left : right;
+            }
+            else if ( tl >= 0 )
+            { stack[top++] = left; }
+            else if ( tr >= 0 )
+            { stack[top++] = right; }
+        }
+    }
+    return found;
+}
+
+} // namespace Picking
+} // namespace Ra
+
+#endif // RADIUMENGINE_PICKING_BVH_HPP
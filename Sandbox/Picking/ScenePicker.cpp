@@ -0,0 +1,207 @@
+#include <Picking/ScenePicker.hpp>
+#include <SceneAabbCache.hpp>
+
+#include <Engine/Data/Mesh.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace Ra {
+namespace Picking {
+
+namespace {
+/// Moller-Trumbore ray/triangle intersection.
+bool intersectTriangle( const Core::Ray& ray,
+                        const Core::Vector3& a,
+                        const Core::Vector3& b,
+                        const Core::Vector3& c,
+                        Scalar& t,
+                        Scalar& u,
+                        Scalar& v ) {
+    const Core::Vector3 ab = b - a;
+    const Core::Vector3 ac = c - a;
+    const Core::Vector3 p  = ray.direction().cross( ac );
+    const Scalar det       = ab.dot( p );
+    if ( std::abs( det ) < std::numeric_limits<Scalar>::epsilon() ) { return false; }
+
+    const Scalar invDet   = 1_ra / det;
+    const Core::Vector3 s = ray.origin() - a;
+    u                     = s.dot( p ) * invDet;
+    if ( u < 0_ra || u > 1_ra ) { return false; }
+    const Core::Vector3 q = s.cross( ab );
+    v                     = ray.direction().dot( q ) * invDet;
+    if ( v < 0_ra || u + v > 1_ra ) { return false; }
+    t = ac.dot( q ) * invDet;
+    return t >= 0_ra;
+}
+} // namespace
+
+ScenePicker::ScenePicker( SceneAabbCache& aabbCache ) : m_aabbCache( aabbCache ) {}
+
+void ScenePicker::addRenderObject( const std::shared_ptr<Engine::Rendering::RenderObject>& ro ) {
+    auto mesh = std::dynamic_pointer_cast<Engine::Data::Mesh>( ro->getMesh() );
+    if ( mesh == nullptr ) { return; }
+
+    Entry& entry   = m_entries[ro->getIndex()];
+    entry          = Entry();
+    entry.ro       = ro;
+    entry.mesh     = mesh;
+    m_sceneChanged = true;
+}
+
+void ScenePicker::removeRenderObject( const Core::Utils::Index& roIndex ) {
+    if ( m_entries.erase( roIndex ) > 0 ) { m_sceneChanged = true; }
+}
+
+void ScenePicker::clear() {
+    m_entries.clear();
+    m_sceneEntries.clear();
+    m_sceneBoxes.clear();
+    m_sceneBvh     = Bvh();
+    m_sceneChanged = true;
+}
+
+void ScenePicker::update() {
+    std::vector<std::pair<Entry*, uint>> outdated;
+    for ( auto& e : m_entries )
+    {
+        const uint version = m_aabbCache.getGeometryVersion( e.first );
+        if ( e.second.version != version ) { outdated.emplace_back( &e.second, version ); }
+    }
+
+    // Interleave the meshes between the tasks to balance large and small ones.
+    const size_t numTasks =
+        std::min( size_t( std::max( 1u, std::thread::hardware_concurrency() ) ), outdated.size() );
+    std::vector<std::future<void>> tasks;
+    for ( size_t task = 0; task < numTasks; ++task )
+    {
+        tasks.push_back( std::async( std::launch::async, [&outdated, task, numTasks]() {
+            for ( size_t i = task; i < outdated.size(); i += numTasks )
+            {
+                updateEntry( *outdated[i].first, outdated[i].second );
+            }
+        } ) );
+    }
+    for ( auto& task : tasks )
+    {
+        task.wait();
+    }
+
+    updateScene();
+}
+
+void ScenePicker::updateScene() {
+    if ( m_sceneChanged )
+    {
+        m_sceneEntries.clear();
+        m_sceneBoxes.clear();
+        for ( auto& e : m_entries )
+        {
+            Entry& entry         = e.second;
+            entry.sceneTransform = entry.ro->getTransform();
+            entry.sceneVersion   = entry.version;
+            m_sceneEntries.push_back( &entry );
+            m_sceneBoxes.push_back( m_aabbCache.getWorldAabb( e.first ) );
+        }
+        m_sceneBvh.build( m_sceneBoxes );
+        m_sceneChanged = false;
+        return;
+    }
+
+    // Only the objects that moved or were deformed get a new box.
+    std::vector<uint> changed;
+    for ( uint i = 0; i < uint( m_sceneEntries.size() ); ++i )
+    {
+        Entry& entry                    = *m_sceneEntries[i];
+        const Core::Transform transform = entry.ro->getTransform();
+        if ( entry.sceneVersion == entry.version &&
+             entry.sceneTransform.matrix() == transform.matrix() )
+        { continue; }
+        entry.sceneTransform = transform;
+        entry.sceneVersion   = entry.version;
+        m_sceneBoxes[i]      = m_aabbCache.getWorldAabb( entry.ro->getIndex() );
+        changed.push_back( i );
+    }
+    if ( !changed.empty() ) { m_sceneBvh.refit( m_sceneBoxes, changed ); }
+}
+
+void ScenePicker::updateEntry( Entry& entry, uint version ) {
+    auto mesh = std::static_pointer_cast<Engine::Data::Mesh>( entry.mesh.lock() );
+    if ( mesh == nullptr ) { return; }
+
+    const auto& geometry = mesh->getCoreGeometry();
+    const auto& vertices = geometry.vertices();
+    const auto& indices  = geometry.getIndices();
+
+    std::vector<Core::Aabb> boxes( indices.size() );
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        boxes[i].extend( vertices[indices[i]( 0 )] );
+        boxes[i].extend( vertices[indices[i]( 1 )] );
+        boxes[i].extend( vertices[indices[i]( 2 )] );
+    }
+
+    // Deformations keep the triangles, the existing hierarchy only has to be refit.
+    if ( entry.version != 0 && entry.bvh.getNumPrimitives() == boxes.size() )
+    { entry.bvh.refit( boxes ); }
+    else
+    { entry.bvh.build( boxes ); }
+    entry.version = version;
+}
+
+PickingHit ScenePicker::pick( const Core::Ray& ray ) {
+    // The scene hierarchy refers to removed entries until it is built again.
+    if ( m_sceneChanged ) { update(); }
+
+    PickingHit hit;
+    Scalar tMax = std::numeric_limits<Scalar>::max();
+    m_sceneBvh.intersect( ray, tMax, [&]( uint i, Scalar& t ) {
+        const Entry& entry = *m_sceneEntries[i];
+        if ( !entry.ro->isVisible() ) { return false; }
+
+        PickingHit meshHit;
+        meshHit.t = t;
+        if ( !intersectMesh( entry, ray, meshHit ) ) { return false; }
+        hit = meshHit;
+        t   = meshHit.t;
+        return true;
+    } );
+    return hit;
+}
+
+bool ScenePicker::intersectMesh( const Entry& entry, const Core::Ray& ray, PickingHit& hit ) {
+    auto mesh = std::static_pointer_cast<Engine::Data::Mesh>( entry.mesh.lock() );
+    if ( mesh == nullptr || entry.bvh.empty() ) { return false; }
+
+    // An affine transform keeps the ray parameterization : distances along the object space
+    // ray are directly comparable with the world space ones.
+    const Core::Transform toObject = entry.ro->getTransform().inverse( Eigen::Affine );
+    const Core::Ray localRay( toObject * ray.origin(), toObject.linear() * ray.direction() );
+
+    const auto& geometry = mesh->getCoreGeometry();
+    const auto& vertices = geometry.vertices();
+    const auto& indices  = geometry.getIndices();
+
+    Scalar tMax = hit.t;
+    return entry.bvh.intersect( localRay, tMax, [&]( uint i, Scalar& t ) {
+        Scalar ti, u, v;
+        const auto& tri = indices[i];
+        if ( !intersectTriangle(
+                 localRay, vertices[tri( 0 )], vertices[tri( 1 )], vertices[tri( 2 )], ti, u, v ) ||
+             ti >= t )
+        { return false; }
+        t                 = ti;
+        hit.roIndex       = entry.ro->getIndex();
+        hit.triangleIndex = int( i );
+        hit.t             = ti;
+        hit.barycentric   = {1_ra - u - v, u, v};
+        return true;
+    } );
+}
+
+} // namespace Picking
+} // namespace Ra
@@ -0,0 +1,104 @@
+#ifndef RADIUMENGINE_PICKING_SCENEPICKER_HPP
+#define RADIUMENGINE_PICKING_SCENEPICKER_HPP
+
+#include <Picking/Bvh.hpp>
+
+#include <Core/Utils/Index.hpp>
+
+#include <map>
+#include <memory>
+
+namespace Ra {
+namespace Engine {
+namespace Data {
+class Displayable;
+} // namespace Data
+namespace Rendering {
+class RenderObject;
+} // namespace Rendering
+} // namespace Engine
+class SceneAabbCache;
+} // namespace Ra
+
+namespace Ra {
+namespace Picking {
+
+/// Result of a ray cast.
+struct PickingHit {
+    bool isValid() const { return roIndex.isValid(); }
+
+    /// Render object hit by the ray, invalid if nothing was hit.
+    Core::Utils::Index roIndex;
+    /// Index of the triangle hit in the render object mesh.
+    int triangleIndex{-1};
+    /// Distance along the ray, in ray direction units.
+    Scalar t{0};
+    /// Barycentric coordinates of the hit point in the triangle.
+    Core::Vector3 barycentric{Core::Vector3::Zero()};
+};
+
+/// CPU ray caster over the triangle meshes of the scene.
+///
+/// Each mesh owns a hierarchy built in object space, so moving an object does not require
+/// rebuilding it : the ray is transformed into object space instead. A scene level hierarchy is
+/// built over the world boxes of the render objects (provided by the SceneAabbCache). Only the
+/// boxes of the objects that moved or were deformed are refit, by update(), which is meant to
+/// be called once per frame : picking itself only casts the ray.
+class ScenePicker
+{
+  public:
+    explicit ScenePicker( SceneAabbCache& aabbCache );
+
+    /// Start tracking a render object. Only triangle meshes can be picked.
+    void addRenderObject( const std::shared_ptr<Engine::Rendering::RenderObject>& ro );
+
+    /// Stop tracking a render object.
+    void removeRenderObject( const Core::Utils::Index& roIndex );
+
+    /// Stop tracking all the render objects.
+    void clear();
+
+    /// Build or refit the hierarchies of the meshes created or modified since the last call,
+    /// in parallel, then update the scene hierarchy for the objects added, removed, moved or
+    /// deformed since the last call.
+    void update();
+
+    /// Closest visible triangle hit by a world space ray, with the object positions of the last
+    /// update(). The hierarchies are only updated here when objects were added or removed.
+    PickingHit pick( const Core::Ray& ray );
+
+  private:
+    struct Entry {
+        std::shared_ptr<Engine::Rendering::RenderObject> ro;
+        std::weak_ptr<Engine::Data::Displayable> mesh;
+        Bvh bvh;
+        /// Geometry version the hierarchy corresponds to, 0 when never built.
+        uint version{0};
+        /// Transform and geometry version of the world box in the scene hierarchy.
+        Core::Transform sceneTransform{Core::Transform::Identity()};
+        uint sceneVersion{0};
+    };
+
+    /// Build the scene hierarchy, or refit it for the entries that changed.
+    void updateScene();
+
+    /// Build or refit the hierarchy of a mesh.
+    static void updateEntry( Entry& entry, uint version );
+
+    static bool intersectMesh( const Entry& entry, const Core::Ray& ray, PickingHit& hit );
+
+    SceneAabbCache& m_aabbCache;
+    std::map<Core::Utils::Index, Entry> m_entries;
+
+    /// Scene level hierarchy, primitive i corresponds to m_sceneEntries[i] and m_sceneBoxes[i].
+    Bvh m_sceneBvh;
+    std::vector<Entry*> m_sceneEntries;
+    std::vector<Core::Aabb> m_sceneBoxes;
+    /// Set when render objects were added or removed since the scene hierarchy was built.
+    bool m_sceneChanged{true};
+};
+
+} // namespace Picking
+} // namespace Ra
+
+#endif // RADIUMENGINE_PICKING_SCENEPICKER_HPP
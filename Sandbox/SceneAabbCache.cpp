@@ -0,0 +1,133 @@
+#include <SceneAabbCache.hpp>
+
+#include <Engine/Data/Mesh.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace Ra {
+
+SceneAabbCache::~SceneAabbCache() {
+    clear();
+}
+
+void SceneAabbCache::addRenderObject( const std::shared_ptr<Engine::Rendering::RenderObject>& ro ) {
+    Entry entry;
+    entry.ro      = ro;
+    entry.version = std::make_shared<uint>( 1 );
+
+    auto mesh = std::dynamic_pointer_cast<Engine::Data::Mesh>( ro->getMesh() );
+    if ( mesh != nullptr )
+    {
+        auto& geometry   = mesh->getCoreGeometry();
+        entry.mesh       = mesh;
+        entry.observerId = geometry.getAttrib( geometry.getVerticesHandle() )
+                               .attach( [version = entry.version]() { ++*version; } );
+    }
+
+    const auto roIndex = ro->getIndex();
+    removeRenderObject( roIndex );
+    m_entries.emplace( roIndex, std::move( entry ) );
+}
+
+void SceneAabbCache::removeRenderObject( const Core::Utils::Index& roIndex ) {
+    auto it = m_entries.find( roIndex );
+    if ( it != m_entries.end() )
+    {
+        detach( it->second );
+        m_entries.erase( it );
+    }
+}
+
+void SceneAabbCache::clear() {
+    for ( auto& entry : m_entries )
+    {
+        detach( entry.second );
+    }
+    m_entries.clear();
+}
+
+Core::Aabb SceneAabbCache::getWorldAabb( const Core::Utils::Index& roIndex ) {
+    auto it = m_entries.find( roIndex );
+    return it != m_entries.end() ? computeWorldAabb( it->second ) : Core::Aabb();
+}
+
+uint SceneAabbCache::getGeometryVersion( const Core::Utils::Index& roIndex ) const {
+    auto it = m_entries.find( roIndex );
+    return it != m_entries.end() ? *it->second.version : 0;
+}
+
+Core::Aabb SceneAabbCache::computeSceneAabb() {
+    std::vector<Entry*> entries;
+    entries.reserve( m_entries.size() );
+    for ( auto& entry : m_entries )
+    {
+        if ( entry.second.ro->isVisible() ) { entries.push_back( &entry.second ); }
+    }
+
+    // Each task owns a disjoint range of entries, so out of date boxes can be refreshed
+    // concurrently.
+    auto reduce = [&entries]( size_t begin, size_t end ) {
+        Core::Aabb aabb;
+        for ( size_t i = begin; i < end; ++i )
+        {
+            aabb.extend( computeWorldAabb( *entries[i] ) );
+        }
+        return aabb;
+    };
+
+    const size_t numThreads = std::max( 1u, std::thread::hardware_concurrency() );
+    const size_t numTasks =
+        std::min( numThreads, ( entries.size() + s_minTaskSize - 1 ) / s_minTaskSize );
+    if ( numTasks <= 1 ) { return reduce( 0, entries.size() ); }
+
+    const size_t taskSize = ( entries.size() + numTasks - 1 ) / numTasks;
+    std::vector<std::future<Core::Aabb>> tasks;
+    for ( size_t begin = taskSize; begin < entries.size(); begin += taskSize )
+    {
+        tasks.push_back( std::async(
+            std::launch::async, reduce, begin, std::min( begin + taskSize, entries.size() ) ) );
+    }
+
+    Core::Aabb aabb = reduce( 0, taskSize );
+    for ( auto& task : tasks )
+    {
+        aabb.extend( task.get() );
+    }
+    return aabb;
+}
+
+Core::Aabb SceneAabbCache::computeWorldAabb( Entry& entry ) {
+    auto mesh = std::static_pointer_cast<Engine::Data::Mesh>( entry.mesh.lock() );
+    if ( mesh == nullptr ) { return entry.ro->computeAabb(); }
+
+    if ( entry.aabbVersion != *entry.version )
+    {
+        entry.localAabb   = mesh->getCoreGeometry().computeAabb();
+        entry.aabbVersion = *entry.version;
+    }
+    if ( entry.localAabb.isEmpty() ) { return entry.localAabb; }
+
+    const Core::Transform transform = entry.ro->getTransform();
+    Core::Aabb aabb;
+    for ( int i = 0; i < 8; ++i )
+    {
+        aabb.extend( transform * entry.localAabb.corner( Core::Aabb::CornerType( i ) ) );
+    }
+    return aabb;
+}
+
+void SceneAabbCache::detach( Entry& entry ) {
+    auto mesh = std::static_pointer_cast<Engine::Data::Mesh>( entry.mesh.lock() );
+    if ( mesh != nullptr && entry.observerId >= 0 )
+    {
+        auto& geometry = mesh->getCoreGeometry();
+        geometry.getAttrib( geometry.getVerticesHandle() ).detach( entry.observerId );
+    }
+    entry.observerId = -1;
+}
+
+} // namespace Ra
@@ -0,0 +1,81 @@
+#ifndef RADIUMENGINE_SCENEAABBCACHE_HPP
+#define RADIUMENGINE_SCENEAABBCACHE_HPP
+
+#include <Core/Types.hpp>
+#include <Core/Utils/Index.hpp>
+
+#include <map>
+#include <memory>
+
+namespace Ra {
+namespace Engine {
+namespace Data {
+class Displayable;
+} // namespace Data
+namespace Rendering {
+class RenderObject;
+} // namespace Rendering
+} // namespace Engine
+} // namespace Ra
+
+namespace Ra {
+
+/// Caches the bounding boxes of the scene render objects.
+///
+/// For triangle meshes, the object-space box is computed once and recomputed only when the
+/// vertex positions are modified (an observer is attached to the position attribute). The
+/// world-space box is then obtained by transforming the 8 corners of the cached box, so moving
+/// an object never requires scanning its vertices again.
+/// Other displayables are not cached and use RenderObject::computeAabb().
+class SceneAabbCache
+{
+  public:
+    SceneAabbCache() = default;
+    SceneAabbCache( const SceneAabbCache& ) = delete;
+    SceneAabbCache& operator=( const SceneAabbCache& ) = delete;
+    ~SceneAabbCache();
+
+    /// Start tracking a render object.
+    void addRenderObject( const std::shared_ptr<Engine::Rendering::RenderObject>& ro );
+
+    /// Stop tracking a render object.
+    void removeRenderObject( const Core::Utils::Index& roIndex );
+
+    /// Stop tracking all the render objects.
+    void clear();
+
+    /// World-space bounding box of a tracked render object (empty if not tracked).
+    Core::Aabb getWorldAabb( const Core::Utils::Index& roIndex );
+
+    /// Counter incremented each time the vertex positions of a tracked triangle mesh change.
+    uint getGeometryVersion( const Core::Utils::Index& roIndex ) const;
+
+    /// Bounding box of all the visible tracked render objects.
+    /// Out of date boxes are recomputed and reduced in parallel.
+    Core::Aabb computeSceneAabb();
+
+  private:
+    struct Entry {
+        std::shared_ptr<Engine::Rendering::RenderObject> ro;
+        /// Mesh observed for modifications, null if the displayable is not cached.
+        std::weak_ptr<Engine::Data::Displayable> mesh;
+        int observerId{-1};
+        /// Incremented by the observer when the vertex positions change.
+        std::shared_ptr<uint> version;
+        /// Version of the geometry localAabb was computed from.
+        uint aabbVersion{0};
+        Core::Aabb localAabb;
+    };
+
+    static Core::Aabb computeWorldAabb( Entry& entry );
+    static void detach( Entry& entry );
+
+    /// Minimum number of render objects processed by each parallel task.
+    static constexpr size_t s_minTaskSize{256};
+
+    std::map<Core::Utils::Index, Entry> m_entries;
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_SCENEAABBCACHE_HPP
@@ -0,0 +1,272 @@
+#include <ShaderWatcher.hpp>
+
+#include <Core/Utils/Log.hpp>
+#include <Engine/Data/ShaderConfiguration.hpp>
+#include <Engine/Data/ShaderProgramManager.hpp>
+#include <Engine/RadiumEngine.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+#include <Engine/Rendering/RenderObjectManager.hpp>
+#include <Engine/Rendering/RenderTechnique.hpp>
+#include <Gui/Viewer/Viewer.hpp>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace Ra {
+
+using namespace Core::Utils; // log
+
+namespace {
+/// Passes of the render techniques whose programs are watched.
+const Core::Utils::Index s_passes[] {Engine::Rendering::DefaultRenderingPasses::LIGHTING_OPAQUE,
+                                     Engine::Rendering::DefaultRenderingPasses::LIGHTING_TRANSPARENT,
+                                     Engine::Rendering::DefaultRenderingPasses::Z_PREPASS};
+} // namespace
+
+const QStringList ShaderWatcher::s_shaderFilters {
+    "*.glsl", "*.vert", "*.frag", "*.geom", "*.tesc", "*.tese", "*.comp", "*.vs", "*.fs", "*.gs"};
+
+ShaderWatcher::ShaderWatcher( Gui::Viewer* viewer, QObject* parent ) :
+    QObject( parent ),
+    m_viewer( viewer ) {
+    m_reloadTimer.setSingleShot( true );
+    m_reloadTimer.setInterval( s_reloadDelay );
+    connect( &m_reloadTimer, &QTimer::timeout, this, &ShaderWatcher::reloadChangedShaders );
+    connect( &m_watcher, &QFileSystemWatcher::fileChanged, this, &ShaderWatcher::onFileChanged );
+    connect(
+        &m_watcher, &QFileSystemWatcher::directoryChanged, this, &ShaderWatcher::onDirectoryChanged );
+    m_includeResolver.addSearchDirectory(
+        QDir( QString::fromStdString( Engine::RadiumEngine::getInstance()->getResourcesDir() ) )
+            .filePath( "Shaders" ) );
+}
+
+void ShaderWatcher::setEnabled( bool enabled ) {
+    m_enabled = enabled;
+    if ( enabled )
+    {
+        m_lastReload = QDateTime::currentDateTime();
+        updateWatchedFiles();
+    }
+    else
+    {
+        m_reloadTimer.stop();
+        m_changedFiles.clear();
+        m_needsFullReload = false;
+        if ( !m_watcher.files().empty() ) { m_watcher.removePaths( m_watcher.files() ); }
+        if ( !m_watcher.directories().empty() ) { m_watcher.removePaths( m_watcher.directories() ); }
+        m_configsByFile.clear();
+    }
+}
+
+void ShaderWatcher::updateWatchedFiles() {
+    // Programs are only created by the first frame rendering the objects, from the sources as
+    // they are now. Programs already known keep the hash of the sources they were compiled from.
+    const ConfigMap configs = sceneConfigs();
+    for ( const auto& config : configs )
+    {
+        if ( m_sourceHashes.count( config.first ) == 0 )
+        { m_sourceHashes.emplace( config.first, sourceHash( config.second ) ); }
+    }
+    if ( !m_enabled ) { return; }
+
+    m_configsByFile.clear();
+    for ( const auto& config : configs )
+    {
+        for ( const auto& stage : config.second.getShaders() )
+        {
+            // Only stages loaded from a file can be watched.
+            if ( !stage.second || stage.first.empty() ) { continue; }
+            const QString path =
+                QFileInfo( QString::fromStdString( stage.first ) ).canonicalFilePath();
+            if ( !path.isEmpty() ) { m_configsByFile[path].insert( config ); }
+        }
+    }
+
+    QStringList files;
+    QSet<QString> directories;
+    for ( const auto& f : m_configsByFile )
+    {
+        files << f.first;
+        directories.insert( QFileInfo( f.first ).absolutePath() );
+    }
+    // Included files are not known from the programs, the other shader files of the directories
+    // are watched as well. In place writes are only notified for watched files.
+    for ( const auto& d : directories )
+    {
+        for ( const auto& entry : QDir( d ).entryInfoList( s_shaderFilters, QDir::Files ) )
+        {
+            const QString path = entry.canonicalFilePath();
+            if ( m_configsByFile.count( path ) == 0 ) { files << path; }
+        }
+    }
+    // Directories are watched too : editors often save by replacing the file, which removes it
+    // from the file watcher.
+    const QStringList oldFiles = m_watcher.files();
+    const QStringList oldDirs  = m_watcher.directories();
+    if ( !oldFiles.empty() ) { m_watcher.removePaths( oldFiles ); }
+    if ( !oldDirs.empty() ) { m_watcher.removePaths( oldDirs ); }
+    if ( !files.empty() ) { m_watcher.addPaths( files ); }
+    if ( !directories.empty() ) { m_watcher.addPaths( directories.values() ); }
+}
+
+void ShaderWatcher::onFileChanged( const QString& path ) {
+    // A file replaced by an editor is no longer watched, watch the new one.
+    if ( !m_watcher.files().contains( path ) && QFileInfo::exists( path ) )
+    { m_watcher.addPath( path ); }
+    // Other shader files may be included by the programs.
+    if ( m_configsByFile.count( path ) == 0 ) { m_needsFullReload = true; }
+    else
+    { m_changedFiles.insert( path ); }
+    m_reloadTimer.start();
+}
+
+void ShaderWatcher::onDirectoryChanged( const QString& path ) {
+    const QDir dir( path );
+    // Shader files replaced by an editor, or new ones, are watched again. Other files (e.g.
+    // editor swap files) are ignored.
+    const QStringList watched = m_watcher.files();
+    const auto entries        = dir.entryInfoList( s_shaderFilters, QDir::Files );
+    for ( const auto& entry : entries )
+    {
+        const QString file = entry.canonicalFilePath();
+        if ( watched.contains( file ) ) { continue; }
+        m_watcher.addPath( file );
+        if ( m_configsByFile.count( file ) > 0 ) { m_changedFiles.insert( file ); }
+        // Any other shader file modified since the last reload may be included by the programs.
+        else if ( entry.lastModified() > m_lastReload )
+        { m_needsFullReload = true; }
+    }
+    if ( m_needsFullReload || !m_changedFiles.empty() ) { m_reloadTimer.start(); }
+}
+
+void ShaderWatcher::reloadModifiedShaders() {
+    ConfigMap modified;
+    const ConfigMap configs = sceneConfigs();
+    for ( const auto& config : configs )
+    {
+        auto it = m_sourceHashes.find( config.first );
+        if ( it == m_sourceHashes.end() || it->second != sourceHash( config.second ) )
+        { modified.insert( config ); }
+    }
+    LOG( logINFO ) << "Reloading " << modified.size() << " of " << configs.size()
+                   << " programs, the sources of the others did not change.";
+    reloadPrograms( modified );
+    m_lastReload = QDateTime::currentDateTime();
+    emit shadersReloaded();
+}
+
+void ShaderWatcher::reloadAllShaders() {
+    reloadAll();
+    m_lastReload = QDateTime::currentDateTime();
+    emit shadersReloaded();
+}
+
+void ShaderWatcher::reloadChangedShaders() {
+    if ( m_needsFullReload )
+    {
+        LOG( logINFO ) << "Shader files changed, reloading all the shaders.";
+        reloadAll();
+    }
+    else
+    {
+        ConfigMap configs;
+        for ( const auto& path : m_changedFiles )
+        {
+            auto it = m_configsByFile.find( path );
+            if ( it != m_configsByFile.end() ) { configs.insert( it->second.begin(), it->second.end() ); }
+        }
+
+        LOG( logINFO ) << m_changedFiles.size() << " shader files changed, reloading "
+                       << configs.size() << " programs.";
+        reloadPrograms( configs );
+    }
+    m_changedFiles.clear();
+    m_needsFullReload = false;
+    m_lastReload      = QDateTime::currentDateTime();
+    emit shadersReloaded();
+}
+
+ShaderWatcher::ConfigMap ShaderWatcher::sceneConfigs() const {
+    ConfigMap configs;
+    auto romgr = Engine::RadiumEngine::getInstance()->getRenderObjectManager();
+    for ( const auto& ro : romgr->getRenderObjects() )
+    {
+        auto technique = ro->getRenderTechnique();
+        if ( technique == nullptr ) { continue; }
+        // Configurations are known as soon as the technique is built.
+        for ( const auto& pass : s_passes )
+        {
+            if ( !technique->hasConfiguration( pass ) ) { continue; }
+            const auto& config = technique->getConfiguration( pass );
+            configs.emplace( config.getName(), config );
+        }
+    }
+    return configs;
+}
+
+QByteArray ShaderWatcher::sourceHash( const Engine::Data::ShaderConfiguration& config ) {
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    for ( const auto& stage : config.getShaders() )
+    {
+        std::string source = stage.first;
+        QString directory;
+        if ( stage.second && !stage.first.empty() )
+        {
+            // A missing file hashes as empty : the program is reloaded when it is back.
+            QFile file( QString::fromStdString( stage.first ) );
+            source    = file.open( QIODevice::ReadOnly | QIODevice::Text ) ?
+                            file.readAll().toStdString() :
+                            std::string();
+            directory = QFileInfo( file ).absolutePath();
+        }
+        const std::string resolved = m_includeResolver.resolve( source, directory );
+        hash.addData( resolved.data(), int( resolved.size() ) + 1 );
+    }
+    for ( const auto& property : config.getProperties() )
+    {
+        hash.addData( property.data(), int( property.size() ) + 1 );
+    }
+    return hash.result();
+}
+
+void ShaderWatcher::reloadPrograms( const ConfigMap& configs ) {
+    // The programs are removed from the manager, which creates them again from the new sources
+    // when the techniques using them ask for them at the next frame.
+    auto programManager = Engine::RadiumEngine::getInstance()->getShaderProgramManager();
+    m_viewer->makeCurrent();
+    for ( const auto& config : configs )
+    {
+        programManager->removeShaderProgram( config.second );
+    }
+    m_viewer->doneCurrent();
+
+    // Setting the configuration again drops the program the techniques were using.
+    auto romgr = Engine::RadiumEngine::getInstance()->getRenderObjectManager();
+    for ( const auto& ro : romgr->getRenderObjects() )
+    {
+        auto technique = ro->getRenderTechnique();
+        if ( technique == nullptr ) { continue; }
+        for ( const auto& pass : s_passes )
+        {
+            if ( !technique->hasConfiguration( pass ) ) { continue; }
+            auto it = configs.find( technique->getConfiguration( pass ).getName() );
+            if ( it != configs.end() ) { technique->setConfiguration( it->second, pass ); }
+        }
+    }
+    for ( const auto& config : configs )
+    {
+        m_sourceHashes[config.first] = sourceHash( config.second );
+    }
+}
+
+void ShaderWatcher::reloadAll() {
+    m_viewer->reloadShaders();
+    for ( const auto& config : sceneConfigs() )
+    {
+        m_sourceHashes[config.first] = sourceHash( config.second );
+    }
+}
+
+} // namespace Ra
@@ -0,0 +1,107 @@
+#ifndef RADIUMENGINE_SHADERWATCHER_HPP
+#define RADIUMENGINE_SHADERWATCHER_HPP
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <Engine/Data/ShaderConfiguration.hpp>
+
+#include <ShaderIncludeResolver.hpp>
+
+#include <map>
+#include <string>
+
+namespace Ra {
+namespace Gui {
+class Viewer;
+} // namespace Gui
+} // namespace Ra
+
+namespace Ra {
+
+/// Reload the shader programs of the scene when their source files are modified.
+///
+/// The stage files of the programs used by the render objects are watched. When some of them
+/// change, only the programs using them are reloaded, through the ShaderProgramManager. Other
+/// shader files (e.g. included files or the renderer own shaders) are not known from the
+/// programs : they are watched too, and a modification of one of them falls back to a full
+/// reload of the shaders.
+/// Modifications are accumulated during a short delay, so that saving several files reloads
+/// each program once.
+///
+/// The sources of the programs, with their includes resolved, are hashed with their defines
+/// when the techniques are built and when the programs are reloaded. Reloading the modified
+/// shaders only recompiles the programs whose hash changed since, whether watching is enabled
+/// or not.
+class ShaderWatcher : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit ShaderWatcher( Gui::Viewer* viewer, QObject* parent = nullptr );
+
+    /// Start or stop watching the shader files.
+    void setEnabled( bool enabled );
+    bool isEnabled() const { return m_enabled; }
+
+    /// Update the watched files from the render objects of the scene, to call when render
+    /// techniques were built.
+    void updateWatchedFiles();
+
+  public slots:
+    /// Reload the programs of the scene whose sources or included files changed.
+    void reloadModifiedShaders();
+    /// Reload all the shaders, the renderer ones included.
+    void reloadAllShaders();
+
+  signals:
+    /// Emitted after shaders were reloaded.
+    void shadersReloaded();
+
+  private slots:
+    void onFileChanged( const QString& path );
+    void onDirectoryChanged( const QString& path );
+    void reloadChangedShaders();
+
+  private:
+    using ConfigMap = std::map<std::string, Engine::Data::ShaderConfiguration>;
+
+    /// Configurations, by name, of the programs used by the render objects.
+    ConfigMap sceneConfigs() const;
+    /// Hash of the resolved sources and of the defines of a program.
+    QByteArray sourceHash( const Engine::Data::ShaderConfiguration& config );
+    /// Remove the programs from the manager and set them again to the techniques using them.
+    void reloadPrograms( const ConfigMap& configs );
+    void reloadAll();
+
+    Gui::Viewer* m_viewer;
+    bool m_enabled{false};
+    QFileSystemWatcher m_watcher;
+    /// Delay accumulating the modifications before reloading.
+    QTimer m_reloadTimer;
+    static constexpr int s_reloadDelay{200};
+
+    /// Configurations, by name, of the programs using each watched stage file.
+    std::map<QString, ConfigMap> m_configsByFile;
+    QSet<QString> m_changedFiles;
+    /// A modification not matching a stage file was detected.
+    bool m_needsFullReload{false};
+    /// Shader files modified after the last reload have to be reloaded.
+    QDateTime m_lastReload;
+    /// Name filters of the shader files in the watched directories.
+    static const QStringList s_shaderFilters;
+
+    ShaderIncludeResolver m_includeResolver;
+    /// Source hash, by configuration name, of the programs as they were last compiled.
+    std::map<std::string, QByteArray> m_sourceHashes;
+};
+
+} // namespace Ra
+
+#endif // RADIUMENGINE_SHADERWATCHER_HPP
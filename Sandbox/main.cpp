@@ -1,9 +1,12 @@
+#include <BenchmarkRunner.hpp>
 #include <MainApplication.hpp>
 
 #include <Gui/Utils/KeyMappingManager.hpp>
 
 #include <Gui/MainWindow.hpp>
 
+#include <ShaderDiskCache.hpp>
+
 class MainWindowFactory : public Ra::Gui::BaseApplication::WindowFactory
 {
   public:
@@ -14,8 +17,21 @@ class MainWindowFactory : public Ra::Gui::BaseApplication::WindowFactory
 };
 
 int main( int argc, char** argv ) {
+    // Benchmark options are not known by BaseApplication, extract them first.
+    const auto bench = Ra::BenchmarkRunner::parseArguments( argc, argv );
+    if ( bench.enabled ) { Ra::BenchmarkRunner::setupHeadlessEnvironment( bench ); }
+
     Ra::MainApplication app( argc, argv );
+    // Must be set before the OpenGL context is created.
+    Ra::relocateShaderDiskCache();
     app.initialize( MainWindowFactory() );
-    app.setContinuousUpdate( false );
+
+    if ( bench.enabled )
+    {
+        auto runner = new Ra::BenchmarkRunner( &app, bench );
+        if ( !runner->start() ) { return 1; }
+    }
+    else
+    { app.setContinuousUpdate( false ); }
     return app.exec();
 }
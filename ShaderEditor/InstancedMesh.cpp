@@ -0,0 +1,147 @@
+#include "InstancedMesh.hpp"
+
+#include <Engine/Data/ShaderProgram.hpp>
+
+#include <globjects/Program.h>
+#include <glbinding/gl/gl.h>
+
+#include <cmath>
+
+using namespace gl;
+
+namespace {
+/// Name of the per instance attribute in the shaders.
+const char* s_instanceAttrib = "in_instance";
+} // namespace
+
+InstancedMesh::InstancedMesh( const std::string& name,
+                              Ra::Core::Geometry::TriangleMesh&& mesh,
+                              std::vector<Instance> instances ) :
+    Ra::Engine::Data::Mesh( name ),
+    m_instances( std::move( instances ) ) {
+    loadGeometry( std::move( mesh ) );
+}
+
+InstancedMesh::~InstancedMesh() {
+    // The viewer makes its context current before releasing the scene.
+    if ( m_vertexArray == 0 ) { return; }
+    for ( const auto& buffer : m_attribBuffers )
+    {
+        glDeleteBuffers( 1, &buffer.second );
+    }
+    glDeleteBuffers( 1, &m_instanceBuffer );
+    glDeleteBuffers( 1, &m_indexBuffer );
+    glDeleteVertexArrays( 1, &m_vertexArray );
+}
+
+std::vector<InstancedMesh::Instance> InstancedMesh::makeGrid( uint count ) {
+    const uint side   = uint( std::ceil( std::sqrt( float( count ) ) ) );
+    const float scale = 0.9f / float( side );
+
+    std::vector<Instance> instances;
+    instances.reserve( count );
+    for ( uint instance = 0; instance < count; ++instance )
+    {
+        instances.emplace_back( ( 2.f * float( instance % side ) + 1.f ) / float( side ) - 1.f,
+                                ( 2.f * float( instance / side ) + 1.f ) / float( side ) - 1.f,
+                                0.f,
+                                scale );
+    }
+    return instances;
+}
+
+void InstancedMesh::updateGL() {
+    if ( !m_glDirty ) { return; }
+    if ( m_vertexArray == 0 )
+    {
+        glGenVertexArrays( 1, &m_vertexArray );
+        glGenBuffers( 1, &m_instanceBuffer );
+        glGenBuffers( 1, &m_indexBuffer );
+    }
+    glBindVertexArray( m_vertexArray );
+
+    // One buffer per attribute of the core mesh, with its values as they are stored.
+    const auto& mesh = getCoreGeometry();
+    for ( const auto& buffer : m_attribBuffers )
+    {
+        glDeleteBuffers( 1, &buffer.second );
+    }
+    m_attribBuffers.clear();
+    m_attribComponents.clear();
+    mesh.vertexAttribs().for_each_attrib( [this]( Ra::Core::Utils::AttribBase* attrib ) {
+        uint buffer = 0;
+        glGenBuffers( 1, &buffer );
+        glBindBuffer( GL_ARRAY_BUFFER, buffer );
+        glBufferData( GL_ARRAY_BUFFER,
+                      GLsizeiptr( attrib->getBufferSize() ),
+                      attrib->dataPtr(),
+                      GL_STATIC_DRAW );
+        m_attribBuffers.emplace_back( attrib->getName(), buffer );
+        m_attribComponents.push_back( uint( attrib->getNumberOfComponents() ) );
+    } );
+
+    glBindBuffer( GL_ARRAY_BUFFER, m_instanceBuffer );
+    glBufferData( GL_ARRAY_BUFFER,
+                  GLsizeiptr( m_instances.size() * sizeof( Instance ) ),
+                  m_instances.data(),
+                  GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    const auto& indices = mesh.getIndices();
+    m_numIndices        = indices.size() * 3;
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+                  GLsizeiptr( indices.size() * sizeof( indices[0] ) ),
+                  indices.data(),
+                  GL_STATIC_DRAW );
+    glBindVertexArray( 0 );
+
+    m_enabledLocations.clear();
+    m_glDirty = false;
+}
+
+void InstancedMesh::render( const Ra::Engine::Data::ShaderProgram* prog ) {
+    if ( m_vertexArray == 0 || prog == nullptr || m_instances.empty() ) { return; }
+    glBindVertexArray( m_vertexArray );
+    // The renderer draws the mesh with the programs of its different passes, and the editor
+    // replaces them : the attributes are bound to each program drawing it.
+    bindAttributes( prog->getProgramObject()->id() );
+    glDrawElementsInstanced( GL_TRIANGLES,
+                             GLsizei( m_numIndices ),
+                             GL_UNSIGNED_INT,
+                             nullptr,
+                             GLsizei( m_instances.size() ) );
+    glBindVertexArray( 0 );
+}
+
+void InstancedMesh::bindAttributes( uint program ) {
+    for ( const auto& location : m_enabledLocations )
+    {
+        glDisableVertexAttribArray( GLuint( location ) );
+    }
+    m_enabledLocations.clear();
+
+    const GLenum scalarType = sizeof( Scalar ) == sizeof( float ) ? GL_FLOAT : GL_DOUBLE;
+    for ( size_t i = 0; i < m_attribBuffers.size(); ++i )
+    {
+        const GLint location = glGetAttribLocation( program, m_attribBuffers[i].first.c_str() );
+        if ( location < 0 ) { continue; }
+        glBindBuffer( GL_ARRAY_BUFFER, m_attribBuffers[i].second );
+        glVertexAttribPointer(
+            GLuint( location ), GLint( m_attribComponents[i] ), scalarType, GL_FALSE, 0, nullptr );
+        glVertexAttribDivisor( GLuint( location ), 0 );
+        glEnableVertexAttribArray( GLuint( location ) );
+        m_enabledLocations.push_back( location );
+    }
+
+    const GLint location = glGetAttribLocation( program, s_instanceAttrib );
+    if ( location >= 0 )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, m_instanceBuffer );
+        glVertexAttribPointer( GLuint( location ), 4, GL_FLOAT, GL_FALSE, 0, nullptr );
+        glVertexAttribDivisor( GLuint( location ), 1 );
+        glEnableVertexAttribArray( GLuint( location ) );
+        m_enabledLocations.push_back( location );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
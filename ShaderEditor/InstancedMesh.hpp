@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Core/Containers/VectorArray.hpp>
+#include <Core/Geometry/TriangleMesh.hpp>
+#include <Engine/Data/Mesh.hpp>
+
+#include <string>
+#include <vector>
+
+/// Mesh drawn several times in a single instanced draw call.
+///
+/// Each instance has a "in_instance" vec4 attribute (xyz offset, w scale) advanced once per
+/// instance. The vertex attributes of the core mesh, and the instance buffer, are bound by name
+/// to the attributes of the program rendering the mesh, attributes the program does not use are
+/// ignored. Shaders may also use gl_InstanceID.
+class InstancedMesh : public Ra::Engine::Data::Mesh
+{
+  public:
+    /// Offset (xyz) and scale (w) of an instance.
+    using Instance = Ra::Core::Vector4f;
+
+    InstancedMesh( const std::string& name,
+                   Ra::Core::Geometry::TriangleMesh&& mesh,
+                   std::vector<Instance> instances );
+    ~InstancedMesh() override;
+
+    /// Instances laid out on a square grid covering [-1,1]^2, for a mesh fitting in [-1,1]^3.
+    static std::vector<Instance> makeGrid( uint count );
+
+    size_t getNumInstances() const { return m_instances.size(); }
+
+    void updateGL() override;
+    void render( const Ra::Engine::Data::ShaderProgram* prog ) override;
+
+  private:
+    /// Bind the buffers to the attributes of program, the vertex array must be bound.
+    void bindAttributes( uint program );
+
+    std::vector<Instance> m_instances;
+    bool m_glDirty {true};
+
+    uint m_vertexArray {0};
+    /// Vertex buffers of the core mesh attributes, with their names.
+    std::vector<std::pair<std::string, uint>> m_attribBuffers;
+    std::vector<uint> m_attribComponents;
+    uint m_instanceBuffer {0};
+    uint m_indexBuffer {0};
+    size_t m_numIndices {0};
+    /// Attribute locations enabled for the last program drawing the mesh.
+    std::vector<int> m_enabledLocations;
+};
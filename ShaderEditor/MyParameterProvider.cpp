@@ -0,0 +1,130 @@
+#include "MyParameterProvider.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <sstream>
+
+using namespace gl;
+
+namespace {
+const char* glslType( MyParameterProvider::ParameterType type ) {
+    switch ( type )
+    {
+    case MyParameterProvider::ParameterType::FLOAT:
+        return "float";
+    case MyParameterProvider::ParameterType::VEC2:
+        return "vec2";
+    case MyParameterProvider::ParameterType::VEC3:
+        return "vec3";
+    case MyParameterProvider::ParameterType::VEC4:
+        return "vec4";
+    }
+    return "float";
+}
+} // namespace
+
+void MyParameterProvider::updateGL() {
+    // Method called before drawing each frame in Renderer::updateRenderObjectsInternal.
+    if ( !m_blockMembers.empty() )
+    {
+        if ( m_uniformBuffer == 0 ) { glGenBuffers( 1, &m_uniformBuffer ); }
+        glBindBuffer( GL_UNIFORM_BUFFER, m_uniformBuffer );
+        if ( m_blockChanged )
+        {
+            glBufferData( GL_UNIFORM_BUFFER, GLsizeiptr( m_blockSize ), nullptr, GL_DYNAMIC_DRAW );
+            m_blockChanged = false;
+            m_dirty        = true;
+        }
+        // The whole block is small, a single upload is cheaper than one per modified member.
+        if ( m_dirty )
+        {
+            std::vector<float> data( m_blockSize / sizeof( float ), 0.f );
+            for ( const auto& member : m_blockMembers )
+            {
+                const auto& param = m_parameters[member.first];
+                for ( int c = 0; c < int( param.type ); ++c )
+                {
+                    data[member.second / sizeof( float ) + size_t( c )] = float( param.value( c ) );
+                }
+            }
+            glBufferSubData( GL_UNIFORM_BUFFER, 0, GLsizeiptr( m_blockSize ), data.data() );
+            for ( auto& p : m_parameters )
+            {
+                p.second.dirty = false;
+            }
+            m_dirty = false;
+        }
+        glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+        glBindBufferBase( GL_UNIFORM_BUFFER, s_uniformBlockBinding, m_uniformBuffer );
+        return;
+    }
+
+    // The name of the parameter corresponds to the shader's uniform name.
+    // Render parameters are kept between frames, only the modified ones are stored again. This
+    // only saves the map updates : RenderParameters::bind still sets every stored parameter as a
+    // uniform on each draw. The uniform block above avoids these per draw uploads.
+    if ( !m_dirty ) { return; }
+    for ( auto& p : m_parameters )
+    {
+        auto& param = p.second;
+        if ( !param.dirty ) { continue; }
+        switch ( param.type )
+        {
+        case ParameterType::FLOAT:
+            m_renderParameters.addParameter( p.first, param.value( 0 ) );
+            break;
+        case ParameterType::VEC2:
+            m_renderParameters.addParameter( p.first, Ra::Core::Vector2( param.value.head<2>() ) );
+            break;
+        case ParameterType::VEC3:
+            m_renderParameters.addParameter( p.first, Ra::Core::Vector3( param.value.head<3>() ) );
+            break;
+        case ParameterType::VEC4:
+            m_renderParameters.addParameter( p.first, param.value );
+            break;
+        }
+        param.dirty = false;
+    }
+    m_dirty = false;
+}
+
+void MyParameterProvider::setUniformBlock( const UniformList& members ) {
+    m_blockMembers.clear();
+    m_blockSize = 0;
+    for ( const auto& member : members )
+    {
+        // std140 : scalars are aligned on 4 bytes, vec2 on 8 bytes, vec3 and vec4 on 16 bytes.
+        const size_t components = size_t( member.second );
+        const size_t alignment  = components == 1 ? 4 : components == 2 ? 8 : 16;
+        const size_t offset     = ( m_blockSize + alignment - 1 ) / alignment * alignment;
+        m_blockMembers.emplace_back( member.first, offset );
+        m_blockSize = offset + components * sizeof( float );
+
+        setParameter( member.first, member.second, getParameter( member.first ) );
+    }
+    m_blockSize    = ( m_blockSize + 15 ) / 16 * 16;
+    m_blockChanged = true;
+
+    // Values are given to a new buffer or back to the render parameters, all of them are set.
+    for ( auto& p : m_parameters )
+    {
+        p.second.dirty = true;
+    }
+    m_dirty = true;
+}
+
+std::string MyParameterProvider::uniformBlockDeclaration( const UniformList& members ) {
+    std::ostringstream decl;
+    decl << "layout (std140) uniform " << s_uniformBlockName << " {\n";
+    for ( const auto& member : members )
+    {
+        decl << "    " << glslType( member.second ) << " " << member.first << ";\n";
+    }
+    decl << "};\n";
+    return decl.str();
+}
+
+void MyParameterProvider::bindUniformBlock( unsigned int program ) {
+    const GLuint index = glGetUniformBlockIndex( program, s_uniformBlockName );
+    if ( index != GL_INVALID_INDEX ) { glUniformBlockBinding( program, index, s_uniformBlockBinding ); }
+}
@@ -2,28 +2,80 @@
 
 #include <Engine/Data/RenderParameters.hpp>
 
+#include <map>
+#include <string>
+
 
 using ShaderConfigType = std::vector<std::pair<Ra::Engine::Data::ShaderType, std::string>> ;
 
 class MyParameterProvider : public Ra::Engine::Data::ShaderParameterProvider
 {
   public:
+    /// Supported uniform types, float vectors are stored in the first components of a Vector4.
+    /// The value of a type is its number of components.
+    enum class ParameterType { FLOAT = 1, VEC2, VEC3, VEC4 };
+    using UniformList = std::vector<std::pair<std::string, ParameterType>>;
+
+    /// Name of the uniform block declared by uniformBlockDeclaration.
+    static constexpr const char* s_uniformBlockName {"Parameters"};
+    /// Uniform buffer binding point of the block.
+    static constexpr unsigned int s_uniformBlockBinding {7};
+
     MyParameterProvider() {}
     ~MyParameterProvider() {}
-    void updateGL() override {
-        // Method called before drawing each frame in Renderer::updateRenderObjectsInternal.
-        // The name of the parameter corresponds to the shader's uniform name.
-        m_renderParameters.addParameter( "aColorUniform", m_colorParameter );
-        m_renderParameters.addParameter( "aScalarUniform", m_scalarParameter );
-    }
+    void updateGL() override;
     void setOrComputeTheParameterValues() {
         // client side computation of the parameters, e.g.
-        m_colorParameter  = Ra::Core::Utils::Color::Red();
-        m_scalarParameter = .5_ra;
+        setParameter( "aColorUniform", ParameterType::VEC4, Ra::Core::Utils::Color::Red() );
+        setParameter( "aScalarUniform", ParameterType::FLOAT, Ra::Core::Vector4 {.5_ra, 0, 0, 0} );
     }
 
+    /// Set the value of a parameter, it is given to the shaders at the next frame.
+    void setParameter( const std::string& name, ParameterType type, const Ra::Core::Vector4& value ) {
+        auto& param = m_parameters[name];
+        if ( param.type == type && param.value == value ) { return; }
+        param.type  = type;
+        param.value = value;
+        param.dirty = true;
+        m_dirty     = true;
+    }
+
+    /// Value of a parameter, zero if it was never set.
+    Ra::Core::Vector4 getParameter( const std::string& name ) const {
+        auto it = m_parameters.find( name );
+        return it != m_parameters.end() ? it->second.value : Ra::Core::Vector4::Zero();
+    }
+
+    /// Give the listed parameters to the shaders through a std140 uniform buffer instead of
+    /// individual uniforms. The buffer is only uploaded when a parameter changes and is bound
+    /// once per frame. An empty list goes back to individual uniforms.
+    /// The shaders must declare the block given by uniformBlockDeclaration( members ).
+    void setUniformBlock( const UniformList& members );
+
+    /// GLSL declaration of a std140 uniform block containing the given members. The block has no
+    /// instance name, so the members are used by the shaders as regular uniforms.
+    static std::string uniformBlockDeclaration( const UniformList& members );
+
+    /// Attach the uniform block of a program, if any, to s_uniformBlockBinding.
+    /// The program context must be current.
+    static void bindUniformBlock( unsigned int program );
+
   private:
-    Ra::Core::Utils::Color m_colorParameter {Ra::Core::Utils::Color::Green()};
-    Scalar m_scalarParameter {1};
-};
+    struct Parameter {
+        ParameterType type {ParameterType::FLOAT};
+        Ra::Core::Vector4 value {Ra::Core::Vector4::Zero()};
+        /// Modified since the last frame.
+        bool dirty {false};
+    };
+    std::map<std::string, Parameter> m_parameters;
+    /// At least one parameter was modified since the last frame.
+    bool m_dirty {false};
 
+    /// Uniform block members and their std140 offset, in bytes.
+    std::vector<std::pair<std::string, size_t>> m_blockMembers;
+    size_t m_blockSize {0};
+    /// Set when the block layout changed and the buffer has to be allocated again.
+    bool m_blockChanged {false};
+    /// Uniform buffer, released with the OpenGL context.
+    unsigned int m_uniformBuffer {0};
+};
@@ -0,0 +1,251 @@
+#include "RegressionRunner.hpp"
+#include "ShaderEditorWidget.hpp"
+
+#include <Core/Utils/Log.hpp>
+#include <Engine/Rendering/Renderer.hpp>
+#include <Gui/BaseApplication.hpp>
+#include <Gui/MainWindowInterface.hpp>
+#include <Gui/Viewer/Viewer.hpp>
+
+#include <QCryptographicHash>
+#include <QDockWidget>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+using namespace Ra::Core::Utils; // log
+
+namespace {
+QJsonObject summary( const std::vector<double>& times ) {
+    QJsonObject stats;
+    if ( times.empty() ) { return stats; }
+    const auto minmax = std::minmax_element( times.begin(), times.end() );
+    stats["mean"] = std::accumulate( times.begin(), times.end(), 0. ) / double( times.size() );
+    stats["min"]  = *minmax.first;
+    stats["max"]  = *minmax.second;
+    return stats;
+}
+
+/// Largest difference between the color channels of two images of the same size.
+int maxDifference( const QImage& a, const QImage& b ) {
+    int diff = 0;
+    for ( int y = 0; y < a.height(); ++y )
+    {
+        const QRgb* la = reinterpret_cast<const QRgb*>( a.constScanLine( y ) );
+        const QRgb* lb = reinterpret_cast<const QRgb*>( b.constScanLine( y ) );
+        for ( int x = 0; x < a.width(); ++x )
+        {
+            diff = std::max( { diff,
+                               std::abs( qRed( la[x] ) - qRed( lb[x] ) ),
+                               std::abs( qGreen( la[x] ) - qGreen( lb[x] ) ),
+                               std::abs( qBlue( la[x] ) - qBlue( lb[x] ) ),
+                               std::abs( qAlpha( la[x] ) - qAlpha( lb[x] ) )} );
+        }
+    }
+    return diff;
+}
+} // namespace
+
+RegressionRunner::RegressionRunner( Ra::Gui::BaseApplication* app,
+                                    ShaderEditorWidget* editor,
+                                    const RegressionOptions& options ) :
+    QObject( app ),
+    m_app( app ),
+    m_editor( editor ),
+    m_options( options ) {}
+
+RegressionOptions RegressionRunner::parseArguments( int& argc, char** argv ) {
+    RegressionOptions options;
+    int kept = 1;
+    for ( int i = 1; i < argc; ++i )
+    {
+        const bool hasValue = i + 1 < argc;
+        if ( std::strcmp( argv[i], "--regression" ) == 0 && hasValue )
+        {
+            options.enabled     = true;
+            options.goldenImage = argv[++i];
+        }
+        else if ( std::strcmp( argv[i], "--record-golden" ) == 0 )
+        { options.recordGolden = true; }
+        else if ( std::strcmp( argv[i], "--tolerance" ) == 0 && hasValue )
+        { options.tolerance = std::max( 0, std::atoi( argv[++i] ) ); }
+        else if ( std::strcmp( argv[i], "--frames" ) == 0 && hasValue )
+        { options.numFrames = unsigned( std::max( 1, std::atoi( argv[++i] ) ) ); }
+        else if ( std::strcmp( argv[i], "--report" ) == 0 && hasValue )
+        { options.reportFile = argv[++i]; }
+        else if ( std::strcmp( argv[i], "--software-gl" ) == 0 )
+        { options.softwareGL = true; }
+        else if ( std::strcmp( argv[i], "--vertex" ) == 0 && hasValue )
+        { options.vertexFile = argv[++i]; }
+        else if ( std::strcmp( argv[i], "--fragment" ) == 0 && hasValue )
+        { options.fragmentFile = argv[++i]; }
+        else if ( std::strcmp( argv[i], "--size" ) == 0 && hasValue )
+        {
+            // e.g. "640x480"
+            int width = 0, height = 0;
+            if ( std::sscanf( argv[++i], "%dx%d", &width, &height ) == 2 && width > 0 &&
+                 height > 0 )
+            {
+                options.width  = width;
+                options.height = height;
+            }
+        }
+        else
+        { argv[kept++] = argv[i]; }
+    }
+    argc       = kept;
+    argv[argc] = nullptr;
+    return options;
+}
+
+void RegressionRunner::setupHeadlessEnvironment( const RegressionOptions& options ) {
+    // Do not override an explicit user choice (e.g. running under xvfb-run with xcb).
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+    { qputenv( "QT_QPA_PLATFORM", "offscreen" ); }
+    if ( options.softwareGL )
+    {
+        qputenv( "LIBGL_ALWAYS_SOFTWARE", "1" );
+        qputenv( "GALLIUM_DRIVER", "llvmpipe" );
+    }
+}
+
+bool RegressionRunner::start() {
+    const std::string stageFiles[] {m_options.vertexFile, m_options.fragmentFile};
+    for ( int stage = 0; stage < 2; ++stage )
+    {
+        if ( stageFiles[stage].empty() ||
+             m_editor->setStageFile( stage, QString::fromStdString( stageFiles[stage] ) ) )
+        { continue; }
+        LOG( logERROR ) << "Regression : unable to read " << stageFiles[stage];
+        return false;
+    }
+
+    // The frame size must not depend on the window size nor on the docks around the viewer.
+    const auto& window = m_app->m_mainWindow;
+    for ( auto dock : window->findChildren<QDockWidget*>() )
+    {
+        dock->hide();
+    }
+    window->centralWidget()->setFixedSize( m_options.width, m_options.height );
+    window->adjustSize();
+
+    LOG( logINFO ) << "Regression : shaders compiled in " << m_editor->getLastCompileTime()
+                   << " ms, rendering " << m_options.numFrames << " frames";
+
+    // Ask for the stats of every single frame.
+    m_app->framesCountForStatsChanged( 1 );
+    connect( m_app,
+             &Ra::Gui::BaseApplication::updateFrameStats,
+             this,
+             &RegressionRunner::onFrameStats );
+    m_app->setContinuousUpdate( true );
+    return true;
+}
+
+void RegressionRunner::addGpuTime( double ms ) {
+    if ( m_gpuTimes.size() < m_options.numFrames ) { m_gpuTimes.push_back( ms ); }
+}
+
+void RegressionRunner::onFrameStats( const std::vector<Ra::Gui::FrameTimerData>& stats ) {
+    for ( const auto& s : stats )
+    {
+        if ( m_renderTimes.size() >= m_options.numFrames ) { break; }
+        m_renderTimes.push_back(
+            double( getIntervalMicro( s.renderData.renderStart, s.renderData.renderEnd ) ) *
+            1e-3 );
+    }
+    if ( m_renderTimes.size() < m_options.numFrames ) { return; }
+
+    disconnect( m_app, nullptr, this, nullptr );
+    m_app->setContinuousUpdate( false );
+    m_app->exit( finish() );
+}
+
+int RegressionRunner::finish() {
+    auto viewer = m_app->m_mainWindow->getViewer();
+    size_t w, h;
+    viewer->makeCurrent();
+    auto pixels = viewer->getRenderer()->grabFrame( w, h );
+    viewer->doneCurrent();
+    if ( int( w ) != m_options.width || int( h ) != m_options.height )
+    {
+        LOG( logERROR ) << "Regression : the frame is " << w << "x" << h << " instead of "
+                        << m_options.width << "x" << m_options.height;
+        return 2;
+    }
+    // Same layout as the frames saved by Viewer::grabFrame.
+    const QImage frame =
+        QImage( pixels.get(), int( w ), int( h ), QImage::Format_ARGB32 ).copy();
+    const QByteArray hash =
+        QCryptographicHash::hash( QByteArray::fromRawData(
+                                      reinterpret_cast<const char*>( frame.constBits() ),
+                                      int( frame.sizeInBytes() ) ),
+                                  QCryptographicHash::Sha1 )
+            .toHex();
+
+    const QString golden = QString::fromStdString( m_options.goldenImage );
+    int exitCode         = 0;
+    int difference       = 0;
+    if ( m_options.recordGolden )
+    {
+        if ( !frame.save( golden ) )
+        {
+            LOG( logERROR ) << "Regression : unable to write " << m_options.goldenImage;
+            return 2;
+        }
+        LOG( logINFO ) << "Regression : golden image recorded to " << m_options.goldenImage;
+    }
+    else
+    {
+        QImage reference( golden );
+        if ( reference.isNull() )
+        {
+            LOG( logERROR ) << "Regression : unable to read " << m_options.goldenImage;
+            return 2;
+        }
+        reference = reference.convertToFormat( QImage::Format_ARGB32 );
+        if ( reference.size() != frame.size() )
+        {
+            LOG( logERROR ) << "Regression : golden image size differs from the frame size";
+            exitCode = 1;
+        }
+        else
+        {
+            difference = reference == frame ? 0 : maxDifference( reference, frame );
+            exitCode   = difference <= m_options.tolerance ? 0 : 1;
+        }
+        LOG( exitCode == 0 ? logINFO : logERROR )
+            << "Regression : frame " << ( exitCode == 0 ? "matches " : "differs from " )
+            << m_options.goldenImage << " (max channel difference " << difference << ")";
+    }
+
+    if ( !m_options.reportFile.empty() )
+    {
+        QJsonObject report;
+        report["golden"]        = golden;
+        report["passed"]        = exitCode == 0;
+        report["maxDifference"] = difference;
+        report["frameHash"]     = QString( hash );
+        report["frames"]        = int( m_renderTimes.size() );
+        report["compileMs"]     = m_editor->getLastCompileTime();
+        report["renderCpuMs"]   = summary( m_renderTimes );
+        report["renderGpuMs"]   = summary( m_gpuTimes );
+
+        QFile file( QString::fromStdString( m_options.reportFile ) );
+        if ( !file.open( QIODevice::WriteOnly ) )
+        {
+            LOG( logERROR ) << "Regression : unable to write " << m_options.reportFile;
+            return 2;
+        }
+        file.write( QJsonDocument( report ).toJson() );
+    }
+    return exitCode;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Gui/TimerData/FrameTimerData.hpp>
+
+#include <QObject>
+
+#include <string>
+#include <vector>
+
+namespace Ra {
+namespace Gui {
+class BaseApplication;
+}
+} // namespace Ra
+
+class ShaderEditorWidget;
+
+/// Command line options of the regression mode.
+struct RegressionOptions {
+    /// True when --regression was given on the command line.
+    bool enabled {false};
+    /// Force Mesa's software rasterizer (llvmpipe).
+    bool softwareGL {false};
+    /// Reference image the last frame is compared to.
+    std::string goldenImage;
+    /// Write the last frame as the reference image instead of comparing it.
+    bool recordGolden {false};
+    /// Maximum difference allowed on each color channel, 0 for an exact match.
+    int tolerance {0};
+    /// Number of rendered frames before grabbing the image.
+    unsigned int numFrames {100};
+    /// Json file receiving the measures, none if empty.
+    std::string reportFile;
+    /// Files of the vertex and fragment stages, the default shaders are used if empty.
+    std::string vertexFile;
+    std::string fragmentFile;
+    /// Size of the rendered frame, fixed so that it does not depend on the window layout.
+    int width {512};
+    int height {512};
+};
+
+/// Headless regression test of the edited shaders, meant to run on machines without GPU.
+///
+/// The stages are loaded from the given files, then the scene is rendered offscreen at a fixed
+/// size, without the docks, for a fixed number of frames. The last frame is compared to (or
+/// recorded as) a golden image. The compile time of the shaders and the CPU and GPU render
+/// times are logged and written to a json report. The application exits with 0 when the image
+/// matches, 1 when it does not and 2 on errors.
+class RegressionRunner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    RegressionRunner( Ra::Gui::BaseApplication* app,
+                      ShaderEditorWidget* editor,
+                      const RegressionOptions& options );
+
+    /// Extract the regression options from the command line.
+    /// Recognized options are removed from argv so that the remaining ones can be parsed by
+    /// Ra::Gui::BaseApplication.
+    static RegressionOptions parseArguments( int& argc, char** argv );
+
+    /// Configure Qt and the OpenGL driver to render without a display, must be called before the
+    /// application is created.
+    static void setupHeadlessEnvironment( const RegressionOptions& options );
+
+    /// Load the stage files in the editor and start rendering the measured frames.
+    /// \return false if a stage file cannot be read.
+    bool start();
+
+  public slots:
+    /// GPU time of a frame, in milliseconds.
+    void addGpuTime( double ms );
+
+  private slots:
+    void onFrameStats( const std::vector<Ra::Gui::FrameTimerData>& stats );
+
+  private:
+    /// Grab the last frame, compare or record it and write the report.
+    /// \return the application exit code.
+    int finish();
+
+    Ra::Gui::BaseApplication* m_app;
+    ShaderEditorWidget* m_editor;
+    RegressionOptions m_options;
+    /// CPU render time of each measured frame, in milliseconds.
+    std::vector<double> m_renderTimes;
+    /// GPU time of the measured frames, in milliseconds.
+    std::vector<double> m_gpuTimes;
+};
@@ -2,37 +2,180 @@
 #include "ui_ShaderEditorWidget.h"
 
 #include "MyParameterProvider.hpp"
+#include "TimeGraph.hpp"
 
+#include <Core/Utils/Log.hpp>
+#include <Engine/RadiumEngine.hpp>
 #include <Engine/Rendering/Renderer.hpp>
 #include <Engine/Rendering/RenderObjectManager.hpp>
 #include <Engine/Rendering/RenderObject.hpp>
+#include <Engine/Rendering/RenderTechnique.hpp>
+#include <Engine/Data/ShaderProgram.hpp>
+
+#include <Gui/Viewer/Viewer.hpp>
 
 // include the custom material definition
 #include <Engine/Data/RawShaderMaterial.hpp>
 
+#include <QCheckBox>
+#include <QDir>
+#include <QDoubleSpinBox>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFormLayout>
+#include <QHBoxLayout>
 #include <QPushButton>
+#include <QRegularExpression>
+#include <QSignalBlocker>
 #include <QString>
 #include <QTextEdit>
+#include <QTextDocument>
+#include <QTimer>
+
+#include <globjects/Program.h>
+#include <glbinding/gl/gl.h>
+
+#include <algorithm>
+
+using namespace Ra::Core::Utils; // log
+
+namespace {
+/// Update the source of a stage from its editor, only when the editor document was modified
+/// since the last call.
+/// \return true if the source changed.
+bool updateStageSource( QTextEdit* edit, std::string& source ) {
+    auto doc = edit->document();
+    if ( !doc->isModified() ) { return false; }
+    doc->setModified( false );
+
+    std::string text = edit->toPlainText().toStdString();
+    if ( text == source ) { return false; }
+    source = std::move( text );
+    return true;
+}
+
+/// Active uniforms of a program that can be edited, struct members, arrays and samplers are
+/// ignored. The program context must be current.
+MyParameterProvider::UniformList editableUniforms( gl::GLuint program ) {
+    using namespace gl;
+    using ParameterType = MyParameterProvider::ParameterType;
+
+    GLint count     = 0;
+    GLint maxLength = 0;
+    glGetProgramiv( program, GL_ACTIVE_UNIFORMS, &count );
+    glGetProgramiv( program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength );
+
+    MyParameterProvider::UniformList uniforms;
+    std::vector< GLchar > name( size_t( std::max( maxLength, 1 ) ) );
+    for ( GLint i = 0; i < count; ++i )
+    {
+        GLsizei length = 0;
+        GLint size     = 0;
+        GLenum type    = GL_NONE;
+        glGetActiveUniform( program, GLuint( i ), maxLength, &length, &size, &type, name.data() );
+        const std::string uniform( name.data(), size_t( length ) );
+        if ( size != 1 || uniform.find_first_of( ".[" ) != std::string::npos ) { continue; }
+
+        if ( type == GL_FLOAT ) { uniforms.emplace_back( uniform, ParameterType::FLOAT ); }
+        else if ( type == GL_FLOAT_VEC2 ) { uniforms.emplace_back( uniform, ParameterType::VEC2 ); }
+        else if ( type == GL_FLOAT_VEC3 ) { uniforms.emplace_back( uniform, ParameterType::VEC3 ); }
+        else if ( type == GL_FLOAT_VEC4 ) { uniforms.emplace_back( uniform, ParameterType::VEC4 ); }
+    }
+    return uniforms;
+}
+
+/// Version directive of the stages checked by the editor : the highest version supported by the
+/// context, the material adds its own. The context must be current.
+std::string versionDirective() {
+    using namespace gl;
+    // e.g. "4.60 NVIDIA" gives "#version 460".
+    const auto version = reinterpret_cast< const char* >( glGetString( GL_SHADING_LANGUAGE_VERSION ) );
+    if ( version == nullptr ) { return "#version 410\n"; }
+    std::string digits;
+    for ( const char* c = version; *c != '\0' && *c != ' '; ++c )
+    {
+        if ( *c != '.' ) { digits += *c; }
+    }
+    return "#version " + digits.substr( 0, 3 ) + "\n";
+}
+
+/// Information log of a shader or program object.
+std::string infoLog( gl::GLuint object, bool program ) {
+    using namespace gl;
+    GLint length = 0;
+    if ( program ) { glGetProgramiv( object, GL_INFO_LOG_LENGTH, &length ); }
+    else { glGetShaderiv( object, GL_INFO_LOG_LENGTH, &length ); }
+    std::string log( size_t( std::max( length, 1 ) ), '\0' );
+    if ( program ) { glGetProgramInfoLog( object, length, nullptr, &log[0] ); }
+    else { glGetShaderInfoLog( object, length, nullptr, &log[0] ); }
+    return log;
+}
+
+MyParameterProvider::ParameterType parameterType( const QString& glslType ) {
+    using ParameterType = MyParameterProvider::ParameterType;
+    if ( glslType == "vec2" ) { return ParameterType::VEC2; }
+    if ( glslType == "vec3" ) { return ParameterType::VEC3; }
+    if ( glslType == "vec4" ) { return ParameterType::VEC4; }
+    return ParameterType::FLOAT;
+}
+} // namespace
 
 ShaderEditorWidget::ShaderEditorWidget(
                                 const std::string& v,
                                 const std::string& f,
                                 std::shared_ptr< Ra::Engine::Rendering::RenderObject > ro,
-                                Ra::Engine::Rendering::Renderer * renderer,
-                                std::shared_ptr< Ra::Engine::Data::ShaderParameterProvider > paramProvider,
+                                Ra::Gui::Viewer * viewer,
+                                std::shared_ptr< MyParameterProvider > paramProvider,
                                 QWidget *parent) :
     QWidget( parent ),
     ui( new Ui::ShaderEditorWidget ),
     _ro( ro ),
-    _renderer( renderer ),
-    _paramProvider( paramProvider )
+    _viewer( viewer ),
+    _paramProvider( paramProvider ),
+    _gpuTimeGraph( new TimeGraph( this ) ),
+    _liveEditTimer( new QTimer( this ) ),
+    _lastValidConfig { {Ra::Engine::Data::ShaderType::ShaderType_VERTEX, v},
+                       {Ra::Engine::Data::ShaderType::ShaderType_FRAGMENT, f} },
+    _editedConfig( _lastValidConfig ),
+    _stageFileWatcher( new QFileSystemWatcher( this ) )
 {
+    // Includes that are not relative to a stage file are the engine shaders, e.g.
+    // TransformStructs.glsl.
+    _includeResolver.addSearchDirectory(
+        QDir( QString::fromStdString( Ra::Engine::RadiumEngine::getInstance()->getResourcesDir() ) )
+            .filePath( "Shaders" ) );
+    for ( auto& stage : _lastValidConfig )
+    {
+        stage.second = _includeResolver.resolve( stage.second );
+    }
+
     ui->setupUi(this);
+    ui->_gpuTimeLayout->addWidget( _gpuTimeGraph );
 
     ui->_vertShaderEdit->setPlainText( QString::fromStdString( v ) );
     ui->_fragShaderEdit->setPlainText( QString::fromStdString( f ) );
 
+    _liveEditTimer->setSingleShot( true );
+    _liveEditTimer->setInterval( s_liveEditDelay );
+
     connect( ui->_compileShaders, &QPushButton::clicked, this, &ShaderEditorWidget::updateShadersFromUI );
+    connect( _liveEditTimer, &QTimer::timeout, this, &ShaderEditorWidget::updateShadersFromUI );
+    connect( ui->_vertShaderEdit, &QTextEdit::textChanged, this, &ShaderEditorWidget::scheduleLiveCompilation );
+    connect( ui->_fragShaderEdit, &QTextEdit::textChanged, this, &ShaderEditorWidget::scheduleLiveCompilation );
+    connect( ui->_liveEdit, &QCheckBox::toggled, this, [this]( bool on ) {
+        if ( on ) { scheduleLiveCompilation(); }
+        else { _liveEditTimer->stop(); }
+    } );
+    connect( ui->_uniformBuffer, &QCheckBox::toggled, this, &ShaderEditorWidget::setUniformBufferEnabled );
+    connect( ui->_vertShaderOpen, &QPushButton::clicked, this, [this]() { openStageFile( 0 ); } );
+    connect( ui->_fragShaderOpen, &QPushButton::clicked, this, [this]() { openStageFile( 1 ); } );
+    connect( _stageFileWatcher, &QFileSystemWatcher::fileChanged, this, &ShaderEditorWidget::onStageFileChanged );
+
+    // Compile the initial shaders to generate the uniform widgets.
+    buildShaders( _lastValidConfig );
 }
 
 ShaderEditorWidget::~ShaderEditorWidget()
@@ -40,16 +183,304 @@ ShaderEditorWidget::~ShaderEditorWidget()
     delete ui;
 }
 
+void
+ShaderEditorWidget::addGpuTime( double ms )
+{
+    _gpuTimeGraph->addTime( ms );
+}
+
+QTextEdit*
+ShaderEditorWidget::stageEdit( int stage ) const
+{
+    return stage == 0 ? ui->_vertShaderEdit : ui->_fragShaderEdit;
+}
+
+void
+ShaderEditorWidget::openStageFile( int stage )
+{
+    const QString path = QFileDialog::getOpenFileName(
+        this, "Open Shader", _stageFiles[stage],
+        "Shaders (*.glsl *.vert *.frag *.vs *.fs);;All files (*)" );
+    if ( !path.isEmpty() ) { setStageFile( stage, path ); }
+}
+
+bool
+ShaderEditorWidget::setStageFile( int stage, const QString& path )
+{
+    if ( !QFileInfo( path ).isReadable() ) { return false; }
+
+    const QString previous = _stageFiles[stage];
+    _stageFiles[stage]     = path;
+    if ( !previous.isEmpty() && previous != _stageFiles[1 - stage] )
+    { _stageFileWatcher->removePath( previous ); }
+    _stageFileWatcher->addPath( path );
+
+    if ( loadStageFile( stage ) ) { updateShadersFromUI(); }
+    return true;
+}
+
+void
+ShaderEditorWidget::onStageFileChanged( const QString& path )
+{
+    // Editors often save by replacing the file, which is then no longer watched.
+    if ( !_stageFileWatcher->files().contains( path ) && QFileInfo::exists( path ) )
+    { _stageFileWatcher->addPath( path ); }
+
+    bool loaded = false;
+    for ( int stage = 0; stage < 2; ++stage )
+    {
+        if ( _stageFiles[stage] == path ) { loaded = loadStageFile( stage ) || loaded; }
+    }
+    // Saves often come as several modifications, compile once they are done.
+    if ( loaded ) { _liveEditTimer->start(); }
+}
+
+bool
+ShaderEditorWidget::loadStageFile( int stage )
+{
+    QFile file( _stageFiles[stage] );
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) { return false; }
+    const QString text = QString::fromUtf8( file.readAll() );
+    if ( text == stageEdit( stage )->toPlainText() ) { return false; }
+
+    stageEdit( stage )->setPlainText( text );
+    stageEdit( stage )->document()->setModified( true );
+    return true;
+}
+
+void
+ShaderEditorWidget::scheduleLiveCompilation()
+{
+    if ( ui->_liveEdit->isChecked() ) { _liveEditTimer->start(); }
+}
+
+QString
+ShaderEditorWidget::stageDirectory( int stage ) const
+{
+    return _stageFiles[stage].isEmpty() ? QString() : QFileInfo( _stageFiles[stage] ).absolutePath();
+}
+
 void
 ShaderEditorWidget::updateShadersFromUI() 
 {
-    using ShaderConfigType = std::vector<std::pair<Ra::Engine::Data::ShaderType, std::string>> ;
+    _liveEditTimer->stop();
+    updateStageSource( ui->_vertShaderEdit, _editedConfig[0].second );
+    updateStageSource( ui->_fragShaderEdit, _editedConfig[1].second );
+
+    QElapsedTimer timer;
+    timer.start();
+    // Included files may be modified without the editors : the stages are preprocessed each
+    // time, from the memoized includes, and only the stages whose text changed are compiled.
+    ShaderConfigType preprocessed = _editedConfig;
+    for ( int stage = 0; stage < 2; ++stage )
+    {
+        preprocessed[stage].second =
+            _includeResolver.resolve( _editedConfig[stage].second, stageDirectory( stage ) );
+    }
+    if ( preprocessed == _lastValidConfig ) { return; }
+
+    _viewer->makeCurrent();
+    const bool valid = compileStages( preprocessed );
+    _viewer->doneCurrent();
+    const double checkTime = double( timer.nsecsElapsed() ) * 1e-6;
 
-    const ShaderConfigType config {
-        {Ra::Engine::Data::ShaderType::ShaderType_VERTEX,   ui->_vertShaderEdit->toPlainText().toStdString()},
-        {Ra::Engine::Data::ShaderType::ShaderType_FRAGMENT, ui->_fragShaderEdit->toPlainText().toStdString()}};
+    // The material is only given stages that compile and link, the last valid program is still
+    // displayed otherwise.
+    if ( !valid )
+    {
+        ui->_compileStatus->setText( QString( "Compilation failed after %1 ms, see the log" ).arg( checkTime, 0, 'f', 1 ) );
+        return;
+    }
+
+    if ( buildShaders( preprocessed ) )
+    {
+        _lastValidConfig = preprocessed;
+        _lastCompileTime += checkTime;
+        ui->_compileStatus->setText( QString( "Compiled and linked in %1 ms" ).arg( _lastCompileTime, 0, 'f', 1 ) );
+        return;
+    }
+    const double time = checkTime + _lastCompileTime;
+
+    // The material may add definitions the editor check does not know about.
+    buildShaders( _lastValidConfig );
+    ui->_compileStatus->setText( QString( "Compilation failed after %1 ms, see the log" ).arg( time, 0, 'f', 1 ) );
+}
+
+bool
+ShaderEditorWidget::compileStages( const ShaderConfigType& preprocessed )
+{
+    using namespace gl;
+    static const std::array< GLenum, 2 > types {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    static const std::array< const char*, 2 > names {"vertex", "fragment"};
 
+    bool changed = false;
+    for ( size_t stage = 0; stage < 2; ++stage )
+    {
+        auto& cache      = _stageCaches[stage];
+        const auto& text = preprocessed[stage].second;
+        if ( cache.shader != 0 && cache.text == text ) { continue; }
+        changed = true;
+
+        if ( cache.shader == 0 ) { cache.shader = glCreateShader( types[stage] ); }
+        const bool hasVersion    = text.compare( 0, 8, "#version" ) == 0;
+        const std::string source = hasVersion ? text : versionDirective() + text;
+        const GLchar* sources[] {source.c_str()};
+        glShaderSource( cache.shader, 1, sources, nullptr );
+        glCompileShader( cache.shader );
+        GLint status = 0;
+        glGetShaderiv( cache.shader, GL_COMPILE_STATUS, &status );
+        cache.text     = text;
+        cache.compiled = status != 0;
+        if ( !cache.compiled )
+        { LOG( logERROR ) << "Shader editor : " << names[stage] << " stage\n" << infoLog( cache.shader, false ); }
+    }
+    if ( !_stageCaches[0].compiled || !_stageCaches[1].compiled ) { return false; }
+    if ( !changed ) { return _checkLinked; }
+
+    if ( _checkProgram == 0 )
+    {
+        _checkProgram = glCreateProgram();
+        for ( const auto& cache : _stageCaches )
+        {
+            glAttachShader( _checkProgram, cache.shader );
+        }
+    }
+    glLinkProgram( _checkProgram );
+    GLint status = 0;
+    glGetProgramiv( _checkProgram, GL_LINK_STATUS, &status );
+    _checkLinked = status != 0;
+    if ( !_checkLinked ) { LOG( logERROR ) << "Shader editor : link\n" << infoLog( _checkProgram, true ); }
+    return _checkLinked;
+}
+
+bool
+ShaderEditorWidget::buildShaders( const ShaderConfigType& config )
+{
+    QElapsedTimer timer;
+    timer.start();
     auto mat           = static_cast<Ra::Engine::Data::RawShaderMaterial*>( _ro->getMaterial().get() );
     mat->updateShaders( config, _paramProvider );
-    _renderer->buildRenderTechnique( _ro.get() );
+    _viewer->getRenderer()->buildRenderTechnique( _ro.get() );
+
+    // Compile now instead of during the next frame, so that a program that fails never reaches
+    // the viewport.
+    _viewer->makeCurrent();
+    auto technique = _ro->getRenderTechnique();
+    technique->updateGL();
+    const auto shader = technique->getShader();
+    UniformList uniforms;
+    if ( shader != nullptr )
+    {
+        const auto program = shader->getProgramObject()->id();
+        MyParameterProvider::bindUniformBlock( program );
+        uniforms = editableUniforms( program );
+    }
+    _viewer->doneCurrent();
+    _lastCompileTime = double( timer.nsecsElapsed() ) * 1e-6;
+
+    if ( shader == nullptr ) { return false; }
+    updateUniformsUI( uniforms );
+    return true;
+}
+
+void
+ShaderEditorWidget::setUniformBufferEnabled( bool on )
+{
+    QString source = ui->_fragShaderEdit->toPlainText();
+    UniformList members;
+    if ( on )
+    {
+        // Replace the float and vector uniform declarations by a block declaring them.
+        static const QRegularExpression uniformDecl(
+            R"(^[ \t]*uniform\s+(float|vec2|vec3|vec4)\s+(\w+)\s*;[^\n]*\n?)",
+            QRegularExpression::MultilineOption );
+        std::vector< std::pair< int, int > > ranges;
+        auto it = uniformDecl.globalMatch( source );
+        while ( it.hasNext() )
+        {
+            const auto match = it.next();
+            members.emplace_back( match.captured( 2 ).toStdString(), parameterType( match.captured( 1 ) ) );
+            ranges.emplace_back( match.capturedStart(), match.capturedLength() );
+        }
+        if ( members.empty() )
+        {
+            QSignalBlocker blocker( ui->_uniformBuffer );
+            ui->_uniformBuffer->setChecked( false );
+            return;
+        }
+        for ( auto r = ranges.rbegin(); r != ranges.rend(); ++r )
+        {
+            source.remove( r->first, r->second );
+        }
+        source.insert( ranges.front().first,
+                       QString::fromStdString( MyParameterProvider::uniformBlockDeclaration( members ) ) );
+    }
+    else
+    {
+        // Declare the block members as individual uniforms again.
+        static const QRegularExpression blockDecl(
+            QString( R"(layout\s*\(\s*std140\s*\)\s*uniform\s+%1\s*\{([^}]*)\}\s*;\n?)" )
+                .arg( MyParameterProvider::s_uniformBlockName ) );
+        static const QRegularExpression memberDecl( R"((float|vec2|vec3|vec4)\s+(\w+)\s*;)" );
+        const auto block = blockDecl.match( source );
+        if ( !block.hasMatch() ) { return; }
+        QString uniforms;
+        auto it = memberDecl.globalMatch( block.captured( 1 ) );
+        while ( it.hasNext() )
+        {
+            const auto match = it.next();
+            uniforms += QString( "uniform %1 %2;\n" ).arg( match.captured( 1 ), match.captured( 2 ) );
+        }
+        source.replace( block.capturedStart(), block.capturedLength(), uniforms );
+    }
+
+    _paramProvider->setUniformBlock( members );
+    ui->_fragShaderEdit->setPlainText( source );
+    ui->_fragShaderEdit->document()->setModified( true );
+    updateShadersFromUI();
+}
+
+void
+ShaderEditorWidget::updateUniformsUI( const UniformList& uniforms )
+{
+    // Regenerating the widgets on each compilation would lose the focus while editing.
+    if ( uniforms == _uniforms ) { return; }
+    _uniforms = uniforms;
+
+    while ( ui->_uniformsLayout->rowCount() > 0 )
+    {
+        ui->_uniformsLayout->removeRow( 0 );
+    }
+
+    for ( const auto& uniform : uniforms )
+    {
+        const auto& name = uniform.first;
+        const auto type  = uniform.second;
+        // Parameters unknown to the provider are registered with their current value.
+        const Ra::Core::Vector4 value = _paramProvider->getParameter( name );
+        _paramProvider->setParameter( name, type, value );
+
+        auto row    = new QWidget;
+        auto layout = new QHBoxLayout( row );
+        layout->setContentsMargins( 0, 0, 0, 0 );
+        // The parameter type value is its number of components.
+        for ( int c = 0; c < int( type ); ++c )
+        {
+            auto spinBox = new QDoubleSpinBox( row );
+            spinBox->setRange( -1000, 1000 );
+            spinBox->setDecimals( 3 );
+            spinBox->setSingleStep( 0.05 );
+            spinBox->setValue( double( value( c ) ) );
+            layout->addWidget( spinBox );
+            connect( spinBox,
+                     QOverload< double >::of( &QDoubleSpinBox::valueChanged ),
+                     this,
+                     [this, name, type, c]( double v ) {
+                         Ra::Core::Vector4 param = _paramProvider->getParameter( name );
+                         param( c )              = Scalar( v );
+                         _paramProvider->setParameter( name, type, param );
+                     } );
+        }
+        ui->_uniformsLayout->addRow( QString::fromStdString( name ), row );
+    }
 }
@@ -1,25 +1,38 @@
 #pragma once
 
+#include "MyParameterProvider.hpp"
+
+#include <ShaderIncludeResolver.hpp>
+
 #include <QWidget>
 
+#include <array>
+#include <utility>
+#include <vector>
+
+class QFileSystemWatcher;
+class QTextEdit;
+class QTimer;
+class TimeGraph;
+
 namespace Ui {
 class ShaderEditorWidget;
 }
 
 namespace Ra{
+namespace Gui{
+    class Viewer;
+}
 namespace Engine{
 namespace Rendering{
     class RenderObject;
     class Renderer;
 }
-namespace Data {
-class ShaderParameterProvider;
-}
 }
 }
 
-///
-/// \todo Add automatic UI generation from parameter provider
+/// Edit the shaders of a RawShaderMaterial and the values of its uniforms.
+/// Uniform widgets are generated from the active uniforms of the compiled program.
 class ShaderEditorWidget : public QWidget
 {
     Q_OBJECT
@@ -28,17 +41,88 @@ public:
     explicit ShaderEditorWidget(const std::string& v,
                                 const std::string& f,
                                 std::shared_ptr< Ra::Engine::Rendering::RenderObject > ro,
-                                Ra::Engine::Rendering::Renderer * renderer,
-                                std::shared_ptr< Ra::Engine::Data::ShaderParameterProvider > paramProvider,
+                                Ra::Gui::Viewer * viewer,
+                                std::shared_ptr< MyParameterProvider > paramProvider,
                                 QWidget *parent = nullptr);
     ~ShaderEditorWidget();
 
+    /// CPU time spent by the last shader compilation and link, in milliseconds.
+    double getLastCompileTime() const { return _lastCompileTime; }
+
+    /// Load a stage (0 : vertex, 1 : fragment) from a file, watch it and compile the shaders.
+    /// \return false if the file cannot be read.
+    bool setStageFile( int stage, const QString& path );
+
+public slots:
+    /// Display the GPU time of a frame, in milliseconds.
+    void addGpuTime( double ms );
+
 private slots:
     void updateShadersFromUI();
+    /// Restart the live edit delay : shaders are compiled once the edition pauses.
+    void scheduleLiveCompilation();
+    /// Move the uniforms declared by the fragment shader to a uniform buffer, or back.
+    void setUniformBufferEnabled( bool on );
+    /// Choose the file of a stage (0 : vertex, 1 : fragment) and watch it.
+    void openStageFile( int stage );
+    /// Reload the stages using a modified file.
+    void onStageFileChanged( const QString& path );
 
 private:
+    QTextEdit * stageEdit( int stage ) const;
+    /// Replace the text of a stage by the content of its file.
+    bool loadStageFile( int stage );
+
+    /// Directory of the file of a stage, used to resolve its relative includes.
+    QString stageDirectory( int stage ) const;
+
+    /// Compile the preprocessed stages whose text changed and link them, without going through
+    /// the material. The editor context must be current.
+    /// \return false if a stage does not compile or the stages do not link.
+    bool compileStages( const ShaderConfigType& preprocessed );
+
+    /// Set the shaders of the material and compile them right away.
+    /// \return false if the program does not compile or link.
+    bool buildShaders( const ShaderConfigType& config );
+
+    using UniformList = MyParameterProvider::UniformList;
+    /// Generate the uniform widgets, only when the list of uniforms changed.
+    void updateUniformsUI( const UniformList& uniforms );
+
     Ui::ShaderEditorWidget *ui;
     std::shared_ptr< Ra::Engine::Rendering::RenderObject > _ro;
-    Ra::Engine::Rendering::Renderer * _renderer;
-    std::shared_ptr< Ra::Engine::Data::ShaderParameterProvider > _paramProvider;
+    Ra::Gui::Viewer * _viewer;
+    std::shared_ptr< MyParameterProvider > _paramProvider;
+
+    TimeGraph * _gpuTimeGraph;
+    /// Uniforms the widgets were generated for.
+    UniformList _uniforms;
+
+    /// Debounce live edit compilations.
+    QTimer * _liveEditTimer;
+    /// Delay without edition before compiling in live edit mode, in milliseconds.
+    static constexpr int s_liveEditDelay {500};
+    /// Last preprocessed shaders given to the material, restored when it fails to build them.
+    ShaderConfigType _lastValidConfig;
+    /// Sources of the editors, only converted when their document was modified.
+    ShaderConfigType _editedConfig;
+    double _lastCompileTime {0};
+
+    /// Resolves the includes of the stages, included files are memoized.
+    Ra::ShaderIncludeResolver _includeResolver;
+    /// Preprocessed text of a stage at its last compilation, and the resulting shader object.
+    struct StageCache {
+        std::string text;
+        unsigned int shader {0};
+        bool compiled {false};
+    };
+    std::array< StageCache, 2 > _stageCaches;
+    /// Program linking the cached stages, to check an edit before giving it to the material.
+    /// Released with the OpenGL context.
+    unsigned int _checkProgram {0};
+    bool _checkLinked {false};
+
+    /// File of each stage, empty if the stage was not loaded from a file.
+    std::array< QString, 2 > _stageFiles;
+    QFileSystemWatcher * _stageFileWatcher;
 };
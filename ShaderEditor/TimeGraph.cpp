@@ -0,0 +1,51 @@
+#include "TimeGraph.hpp"
+
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+#include <numeric>
+
+TimeGraph::TimeGraph( QWidget* parent ) : QWidget( parent ) {
+    setMinimumHeight( 60 );
+}
+
+void TimeGraph::addTime( double ms ) {
+    m_times.push_back( ms );
+    if ( m_times.size() > s_numSamples ) { m_times.pop_front(); }
+    update();
+}
+
+void TimeGraph::paintEvent( QPaintEvent* /*event*/ ) {
+    QPainter painter( this );
+    painter.fillRect( rect(), palette().base() );
+    if ( m_times.empty() ) { return; }
+
+    // Scale on the largest visible measure, with at least 1 ms full height.
+    const double maxMeasure = *std::max_element( m_times.begin(), m_times.end() );
+    const double maxTime    = std::max( 1., maxMeasure );
+    const double xStep   = double( width() ) / double( s_numSamples - 1 );
+    const double yScale  = double( height() - 1 ) / maxTime;
+    const double x0      = double( width() ) - xStep * double( m_times.size() - 1 );
+
+    QPainterPath path;
+    for ( size_t i = 0; i < m_times.size(); ++i )
+    {
+        const QPointF p( x0 + xStep * double( i ), height() - 1 - m_times[i] * yScale );
+        if ( i == 0 ) { path.moveTo( p ); }
+        else
+        { path.lineTo( p ); }
+    }
+    painter.setPen( palette().highlight().color() );
+    painter.drawPath( path );
+
+    const double average =
+        std::accumulate( m_times.begin(), m_times.end(), 0. ) / double( m_times.size() );
+    painter.setPen( palette().text().color() );
+    painter.drawText( rect().adjusted( 4, 2, -4, -2 ),
+                      Qt::AlignTop | Qt::AlignLeft,
+                      QString( "GPU %1 ms (average %2 ms, max %3 ms)" )
+                          .arg( m_times.back(), 0, 'f', 3 )
+                          .arg( average, 0, 'f', 3 )
+                          .arg( maxMeasure, 0, 'f', 3 ) );
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QWidget>
+
+#include <deque>
+
+/// Rolling graph of the last measured times.
+class TimeGraph : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    explicit TimeGraph( QWidget* parent = nullptr );
+
+    QSize sizeHint() const override { return {200, 80}; }
+
+  public slots:
+    /// Add a measure, in milliseconds. The oldest one is dropped when the graph is full.
+    void addTime( double ms );
+
+  protected:
+    void paintEvent( QPaintEvent* event ) override;
+
+  private:
+    static constexpr size_t s_numSamples {240};
+    std::deque<double> m_times;
+};
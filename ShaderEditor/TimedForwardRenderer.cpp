@@ -0,0 +1,35 @@
+#include "TimedForwardRenderer.hpp"
+
+#include <glbinding/gl/gl.h>
+
+using namespace gl;
+
+TimedForwardRenderer::~TimedForwardRenderer() {
+    // The viewer makes its context current before releasing its renderers.
+    if ( m_queries[0] != 0 ) { glDeleteQueries( GLsizei( m_queries.size() ), m_queries.data() ); }
+}
+
+void TimedForwardRenderer::renderInternal( const Ra::Engine::Data::ViewingParameters& renderData ) {
+    if ( m_queries[0] == 0 ) { glGenQueries( GLsizei( m_queries.size() ), m_queries.data() ); }
+
+    const size_t slot = 2 * ( m_frame % s_numFrames );
+    // Read back the frame that used these queries, only if the GPU already finished it.
+    if ( m_frame >= s_numFrames && m_gpuTimeCallback )
+    {
+        GLint available = 0;
+        glGetQueryObjectiv( m_queries[slot + 1], GL_QUERY_RESULT_AVAILABLE, &available );
+        if ( available != 0 )
+        {
+            GLuint64 start = 0;
+            GLuint64 end   = 0;
+            glGetQueryObjectui64v( m_queries[slot], GL_QUERY_RESULT, &start );
+            glGetQueryObjectui64v( m_queries[slot + 1], GL_QUERY_RESULT, &end );
+            m_gpuTimeCallback( double( end - start ) * 1e-6 );
+        }
+    }
+
+    glQueryCounter( m_queries[slot], GL_TIMESTAMP );
+    ForwardRenderer::renderInternal( renderData );
+    glQueryCounter( m_queries[slot + 1], GL_TIMESTAMP );
+    ++m_frame;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Engine/Rendering/ForwardRenderer.hpp>
+
+#include <array>
+#include <functional>
+
+/// Forward renderer measuring the GPU time of its main render pass with timestamp queries.
+///
+/// Queries are kept in a ring of several frames and only read back once their result is
+/// available, so measuring never stalls the pipeline. A result that is not available when its
+/// queries are reused is dropped.
+class TimedForwardRenderer : public Ra::Engine::Rendering::ForwardRenderer
+{
+  public:
+    /// Called with the GPU time of a frame, in milliseconds, a few frames after it was rendered.
+    using GpuTimeCallback = std::function<void( double )>;
+
+    TimedForwardRenderer() = default;
+    ~TimedForwardRenderer() override;
+
+    std::string getRendererName() const override { return "Timed Forward Renderer"; }
+
+    void setGpuTimeCallback( GpuTimeCallback callback ) { m_gpuTimeCallback = callback; }
+
+  protected:
+    void renderInternal( const Ra::Engine::Data::ViewingParameters& renderData ) override;
+
+  private:
+    /// Number of frames in flight before a query is reused.
+    static constexpr size_t s_numFrames {3};
+
+    /// Start and end timestamp queries of each frame in flight, 0 until created.
+    std::array<uint, 2 * s_numFrames> m_queries {};
+    size_t m_frame {0};
+    GpuTimeCallback m_gpuTimeCallback;
+};
@@ -4,6 +4,7 @@
 
 // include the Engine/entity/component interface
 #include <Core/Geometry/MeshPrimitives.hpp>
+#include <Core/Utils/Log.hpp>
 #include <Engine/Scene/GeometryComponent.hpp>
 #include <Engine/Scene/EntityManager.hpp>
 #include <Engine/Rendering/RenderObjectManager.hpp>
@@ -16,14 +17,24 @@
 #include <Gui/Viewer/Viewer.hpp>
 
 #include "CameraManipulator.hpp"
+#include "InstancedMesh.hpp"
 #include "ShaderEditorWidget.hpp"
 #include "MyParameterProvider.hpp"
+#include "RegressionRunner.hpp"
+#include "TimedForwardRenderer.hpp"
 
+#include <ShaderDiskCache.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 // Qt
-#include <QTimer>
 #include <QDockWidget>
+#include <QTimer>
 
 /**
  * Demonstrate the usage of RawShaderMaterial functionalities
@@ -31,13 +42,16 @@
 // Vertex shader source code
 const std::string _vertexShaderSource {"#include \"TransformStructs.glsl\"\n"
                                        "layout (location = 0) in vec3 in_position;\n"
+                                       "// Offset (xyz) and scale (w) of the instance\n"
+                                       "in vec4 in_instance;\n"
                                        "layout (location = 0) out vec3 out_pos;\n"
                                        "uniform Transform transform;\n"
                                        "void main(void)\n"
                                        "{\n"
                                        "    mat4 mvp    = transform.proj * transform.view;\n"
+                                       "    vec3 pos    = in_instance.xyz + in_instance.w * in_position;\n"
                                        "    out_pos     = in_position;\n"
-                                       "    gl_Position = mvp*vec4(in_position.xyz, 1.0);\n"
+                                       "    gl_Position = mvp*vec4(pos, 1.0);\n"
                                        "}\n"};
 // Fragment shader source code
 const std::string _fragmentShaderSource {
@@ -59,15 +73,145 @@ const ShaderConfigType defaultConfig {
 auto paramProvider = std::make_shared<MyParameterProvider>();
 
 
+/// Options of the application, not known by BaseApplication.
+struct EditorOptions {
+    /// Number of instances of the shape, laid out on a grid.
+    uint instances {1};
+    /// Shape to display : "quad" or "box".
+    std::string shape {"quad"};
+    /// Wavefront OBJ file displayed instead of the shape, if not empty.
+    std::string mesh;
+};
+
+/// Extract the editor options from the command line, remaining arguments are left for
+/// BaseApplication.
+EditorOptions parseArguments( int& argc, char** argv ) {
+    EditorOptions options;
+    int kept = 1;
+    for ( int i = 1; i < argc; ++i )
+    {
+        const bool hasValue = i + 1 < argc;
+        if ( std::strcmp( argv[i], "--instances" ) == 0 && hasValue )
+        { options.instances = uint( std::max( 1, std::atoi( argv[++i] ) ) ); }
+        else if ( std::strcmp( argv[i], "--shape" ) == 0 && hasValue )
+        { options.shape = argv[++i]; }
+        else if ( std::strcmp( argv[i], "--mesh" ) == 0 && hasValue )
+        { options.mesh = argv[++i]; }
+        else
+        { argv[kept++] = argv[i]; }
+    }
+    argc       = kept;
+    argv[argc] = nullptr;
+    return options;
+}
+
+/**
+ * Read the positions and faces of a Wavefront OBJ file, polygons are split in triangle fans.
+ * The mesh is centered and scaled to fit in [-1,1]^3, normals are averaged from the faces.
+ * @return false if the file cannot be read or has no face.
+ */
+bool loadObjMesh( const std::string& filename, Ra::Core::Geometry::TriangleMesh& mesh ) {
+    std::ifstream file( filename );
+    if ( !file ) { return false; }
+
+    Ra::Core::Vector3Array vertices;
+    Ra::Core::Geometry::TriangleMesh::IndexContainerType indices;
+    std::string line;
+    while ( std::getline( file, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string type;
+        tokens >> type;
+        if ( type == "v" )
+        {
+            Ra::Core::Vector3 v;
+            tokens >> v.x() >> v.y() >> v.z();
+            vertices.push_back( v );
+        }
+        else if ( type == "f" )
+        {
+            // Vertices are given as "v", "v/vt", "v//vn" or "v/vt/vn", negative from the end.
+            std::vector<uint> face;
+            std::string vertex;
+            while ( tokens >> vertex )
+            {
+                const int index = std::atoi( vertex.c_str() );
+                const int v     = index < 0 ? int( vertices.size() ) + index : index - 1;
+                if ( v < 0 || v >= int( vertices.size() ) ) { return false; }
+                face.push_back( uint( v ) );
+            }
+            for ( size_t i = 2; i < face.size(); ++i )
+            {
+                indices.emplace_back( face[0], face[i - 1], face[i] );
+            }
+        }
+    }
+    if ( indices.empty() ) { return false; }
+
+    Ra::Core::Aabb aabb;
+    for ( const auto& v : vertices )
+    {
+        aabb.extend( v );
+    }
+    const Ra::Core::Vector3 center = aabb.center();
+    const Scalar scale             = 2_ra / std::max( aabb.sizes().maxCoeff(), 1e-6_ra );
+    Ra::Core::Vector3Array normals( vertices.size(), Ra::Core::Vector3::Zero() );
+    for ( auto& v : vertices )
+    {
+        v = ( v - center ) * scale;
+    }
+    for ( const auto& t : indices )
+    {
+        const Ra::Core::Vector3 n =
+            ( vertices[t[1]] - vertices[t[0]] ).cross( vertices[t[2]] - vertices[t[0]] );
+        for ( int i = 0; i < 3; ++i )
+        {
+            normals[t[i]] += n;
+        }
+    }
+    for ( auto& n : normals )
+    {
+        n.normalize();
+    }
+
+    mesh.setVertices( std::move( vertices ) );
+    mesh.setNormals( std::move( normals ) );
+    mesh.setIndices( std::move( indices ) );
+    return true;
+}
+
+/**
+ * Build the mesh given on the command line : the loaded mesh, or the shape.
+ * @return false, after logging the error, if the shape is unknown or the mesh cannot be loaded.
+ */
+bool makeShape( const EditorOptions& options, Ra::Core::Geometry::TriangleMesh& mesh ) {
+    using namespace Ra::Core::Utils; // log
+    if ( !options.mesh.empty() )
+    {
+        if ( loadObjMesh( options.mesh, mesh ) ) { return true; }
+        LOG( logERROR ) << "Unable to load the mesh " << options.mesh;
+        return false;
+    }
+    if ( options.shape == "quad" ) { mesh = Ra::Core::Geometry::makeZNormalQuad( {1_ra, 1_ra} ); }
+    else if ( options.shape == "box" )
+    { mesh = Ra::Core::Geometry::makeSharpBox( Ra::Core::Vector3::Constant( .5_ra ) ); }
+    else
+    {
+        LOG( logERROR ) << "Unknown shape " << options.shape << ", expected quad or box";
+        return false;
+    }
+    return true;
+}
+
 /**
- * Generate a quad with a ShaderMaterial attached
+ * Generate a shape, drawn once or as a grid of instances, with a ShaderMaterial attached
  * @param app
+ * @param shape The mesh to display, expected to fit in [-1,1]^3.
+ * @param instances Number of instances of the mesh.
  * @return The renderObject associated to the created component.
  */
-std::shared_ptr<Ra::Engine::Rendering::RenderObject> initQuad( Ra::Gui::BaseApplication& app ) {
-    //! [Creating the quad]
-    auto quad = Ra::Core::Geometry::makeZNormalQuad( {1_ra, 1_ra} );
-
+std::shared_ptr<Ra::Engine::Rendering::RenderObject>
+initQuad( Ra::Gui::BaseApplication& app, Ra::Core::Geometry::TriangleMesh shape, uint instances ) {
     //! [Create the engine entity for the quad]
     auto e = app.m_engine->getEntityManager()->createEntity( "Quad Entity" );
 
@@ -78,7 +222,8 @@ std::shared_ptr<Ra::Engine::Rendering::RenderObject> initQuad( Ra::Gui::BaseAppl
     Ra::Core::Asset::RawShaderMaterialData mat {"Quad Material", defaultConfig, paramProvider};
 
     //! [Create a geometry component using the custom material]
-    auto c = new Ra::Engine::Scene::TriangleMeshComponent( "Quad Mesh", e, std::move( quad ), &mat );
+    auto c = new Ra::Engine::Scene::TriangleMeshComponent(
+        "Quad Mesh", e, Ra::Core::Geometry::TriangleMesh( shape ), &mat );
 
     //! [Register the entity/component association to the geometry system ]
     auto system = app.m_engine->getSystem( "GeometrySystem" );
@@ -88,27 +233,53 @@ std::shared_ptr<Ra::Engine::Rendering::RenderObject> initQuad( Ra::Gui::BaseAppl
     auto ro = Ra::Engine::RadiumEngine::getInstance()->getRenderObjectManager()->getRenderObject(
         c->m_renderObjects[0] );
 
+    //! [Draw the shape with a single instanced draw call]
+    ro->setMesh( std::make_shared<InstancedMesh>(
+        "Quad Instances",
+        std::move( shape ),
+        instances > 1 ? InstancedMesh::makeGrid( instances )
+                      : std::vector<InstancedMesh::Instance> {{0.f, 0.f, 0.f, 1.f}} ) );
+
     // Initialize all OpenGL state for the scene content
     app.m_mainWindow->postLoadFile( "Cube" );
     return ro;
 }
 
 int main( int argc, char* argv[] ) {
+    const auto regression = RegressionRunner::parseArguments( argc, argv );
+    if ( regression.enabled ) { RegressionRunner::setupHeadlessEnvironment( regression ); }
+    const auto options = parseArguments( argc, argv );
+    Ra::Core::Geometry::TriangleMesh shape;
+    if ( !makeShape( options, shape ) ) { return EXIT_FAILURE; }
     Ra::Gui::BaseApplication app( argc, argv );
+    // Must be set before the OpenGL context is created.
+    Ra::relocateShaderDiskCache();
     app.initialize( Ra::Gui::SimpleWindowFactory {} );
 
     //! [add the custom material to the material system]
     Ra::Engine::Data::RawShaderMaterial::registerMaterial();
 
-    auto ro = initQuad( app );
+    //! [Measure the GPU cost of the shaders, the renderer must be active before creating the quad]
+    auto viewer   = app.m_mainWindow->getViewer();
+    auto renderer = std::make_shared<TimedForwardRenderer>();
+    viewer->changeRenderer( viewer->addRenderer( renderer ) );
+
+    auto ro = initQuad( app, std::move( shape ), options.instances );
 
-    auto viewer = app.m_mainWindow->getViewer();
     viewer->setCameraManipulator(
         new CameraManipulator2D( *( viewer->getCameraManipulator() ) ) );
 
     QDockWidget* dock = new QDockWidget("Shaders editor");
-    dock->setWidget( new ShaderEditorWidget(defaultConfig[0].second, defaultConfig[1].second, ro, viewer->getRenderer(), paramProvider, dock) );
+    auto editor = new ShaderEditorWidget(defaultConfig[0].second, defaultConfig[1].second, ro, viewer, paramProvider, dock);
+    dock->setWidget( editor );
     app.m_mainWindow->addDockWidget(Qt::LeftDockWidgetArea, dock);
+    RegressionRunner* runner = nullptr;
+    if ( regression.enabled ) { runner = new RegressionRunner( &app, editor, regression ); }
+    renderer->setGpuTimeCallback( [editor, runner]( double ms ) {
+        editor->addGpuTime( ms );
+        if ( runner ) { runner->addGpuTime( ms ); }
+    } );
+    if ( runner && !runner->start() ) { return 2; }
 
     return app.exec();
 }